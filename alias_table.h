@@ -0,0 +1,77 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Walker's alias method with Vose's construction: O(n) to build, O(1) to
+// sample. Each sample takes one 64-bit random word; the high half picks a
+// column by multiply-shift and the low half is compared against the column's
+// 32-bit threshold, so sampling needs no floating point and no search.
+class AliasTable {
+public:
+    AliasTable() = default;
+
+    explicit AliasTable(const std::vector<double>& weights) {
+        size_t n = weights.size();
+        threshold.assign(n, 0);
+        alias.assign(n, 0);
+        if (n == 0) return;
+
+        double total = 0;
+        for (double w : weights) total += w > 0 ? w : 0;
+        if (total <= 0) {
+            for (size_t i = 0; i < n; ++i) {
+                threshold[i] = UINT32_MAX;
+                alias[i] = static_cast<uint32_t>(i);
+            }
+            return;
+        }
+
+        std::vector<double> scaled(n);
+        std::vector<uint32_t> small;
+        std::vector<uint32_t> large;
+        for (size_t i = 0; i < n; ++i) {
+            scaled[i] = (weights[i] > 0 ? weights[i] : 0) * n / total;
+            (scaled[i] < 1.0 ? small : large).push_back(static_cast<uint32_t>(i));
+        }
+        while (!small.empty() && !large.empty()) {
+            uint32_t s = small.back();
+            small.pop_back();
+            uint32_t l = large.back();
+            threshold[s] = to_threshold(scaled[s]);
+            alias[s] = l;
+            scaled[l] -= 1.0 - scaled[s];
+            if (scaled[l] < 1.0) {
+                large.pop_back();
+                small.push_back(l);
+            }
+        }
+        // Whatever is left is 1 up to rounding error.
+        for (uint32_t i : large) {
+            threshold[i] = UINT32_MAX;
+            alias[i] = i;
+        }
+        for (uint32_t i : small) {
+            threshold[i] = UINT32_MAX;
+            alias[i] = i;
+        }
+    }
+
+    size_t sample(uint64_t random) const {
+        uint32_t column = static_cast<uint32_t>(((random >> 32) * threshold.size()) >> 32);
+        return static_cast<uint32_t>(random) < threshold[column] ? column : alias[column];
+    }
+
+    size_t size() const { return threshold.size(); }
+
+private:
+    static uint32_t to_threshold(double p) {
+        if (p <= 0) return 0;
+        if (p >= 1) return UINT32_MAX;
+        return static_cast<uint32_t>(p * 4294967296.0);
+    }
+
+    std::vector<uint32_t> threshold;
+    std::vector<uint32_t> alias;
+};
@@ -1,215 +1,2827 @@
-#include <iostream>
-#include <vector>
-#include <string>
-#include <sstream>
-#include <fstream>
-#include <random>
-#include <chrono>
-#include <thread>
-#include <shared_mutex> 
-#include <mutex>
-#include <algorithm>
-#include <iomanip>
-
-enum class OpType { READ, WRITE, STRING };
-
-struct Op {
-    OpType type;
-    int idx;   
-    int value; 
-};
-
-class MultiField {
-public:
-    explicit MultiField(size_t m) : vals(m, 0), locks(m) {}
-
-    int read(size_t idx) const {
-        if (idx >= vals.size()) return 0;
-        std::shared_lock<std::shared_mutex> lk(locks[idx]);
-        return vals[idx];
-    }
-
-    void write(size_t idx, int value) {
-        if (idx >= vals.size()) return;
-        std::unique_lock<std::shared_mutex> lk(locks[idx]);
-        vals[idx] = value;
-    }
-
-    std::string to_string() const {
-        std::vector<std::shared_lock<std::shared_mutex>> acquired_locks;
-        acquired_locks.reserve(locks.size());
-        for (auto& mtx : locks) {
-            acquired_locks.emplace_back(mtx);
-        }
-
-        std::ostringstream oss;
-        oss << "{";
-        for (size_t i = 0; i < vals.size(); ++i) {
-            if (i > 0) oss << ", ";
-            oss << vals[i];
-        }
-        oss << "}";
-        return oss.str();
-    }
-
-    operator std::string() const {
-        return to_string();
-    }
-
-private:
-    std::vector<int> vals;
-    mutable std::vector<std::shared_mutex> locks;
-};
-
-std::vector<Op> load_ops(const std::string& filename) {
-    std::ifstream ifs(filename);
-    std::vector<Op> ops;
-    if (!ifs.is_open()) {
-        std::cerr << "Error opening file: " << filename << std::endl;
-        return ops;
-    }
-    std::string cmd;
-    while (ifs >> cmd) {
-        if (cmd == "read") {
-            int idx; ifs >> idx;
-            ops.push_back({ OpType::READ, idx, 0 });
-        }
-        else if (cmd == "write") {
-            int idx, val; ifs >> idx >> val;
-            ops.push_back({ OpType::WRITE, idx, val });
-        }
-        else if (cmd == "string") {
-            ops.push_back({ OpType::STRING, 0, 0 });
-        }
-    }
-    return ops;
-}
-
-void worker(MultiField& data, const std::vector<Op>& ops) {
-    for (const auto& op : ops) {
-        switch (op.type) {
-        case OpType::READ:
-            data.read(op.idx);
-            break;
-        case OpType::WRITE:
-            data.write(op.idx, op.value);
-            break;
-        case OpType::STRING: {
-            std::string s = data;
-            volatile size_t len = s.length();
-            (void)len;
-            break;
-        }
-        }
-    }
-}
-
-std::mt19937 rng(std::random_device{}());
-void generate_variant6_files(size_t count, int thread_idx) {
-    std::string fname = "var6_t" + std::to_string(thread_idx) + ".txt";
-    std::ofstream ofs(fname);
-    std::discrete_distribution<int> dist({ 20, 5, 20, 5, 20, 5, 25 });
-    std::uniform_int_distribution<int> val_dist(1, 100);
-
-    for (size_t i = 0; i < count; ++i) {
-        int action = dist(rng);
-        switch (action) {
-        case 0: ofs << "read 0\n"; break;
-        case 1: ofs << "write 0 " << val_dist(rng) << "\n"; break;
-        case 2: ofs << "read 1\n"; break;
-        case 3: ofs << "write 1 " << val_dist(rng) << "\n"; break;
-        case 4: ofs << "read 2\n"; break;
-        case 5: ofs << "write 2 " << val_dist(rng) << "\n"; break;
-        case 6: ofs << "string\n"; break;
-        }
-    }
-}
-
-void generate_uniform_files(size_t count, int thread_idx, int m) {
-    std::string fname = "uniform_t" + std::to_string(thread_idx) + ".txt";
-    std::ofstream ofs(fname);
-    std::uniform_int_distribution<int> field_dist(0, m - 1);
-    std::uniform_int_distribution<int> type_dist(0, 2); 
-    std::uniform_int_distribution<int> val_dist(1, 100);
-
-    for (size_t i = 0; i < count; ++i) {
-        int t = type_dist(rng);
-        if (t == 0) ofs << "read " << field_dist(rng) << "\n";
-        else if (t == 1) ofs << "write " << field_dist(rng) << " " << val_dist(rng) << "\n";
-        else ofs << "string\n";
-    }
-}
-
-void generate_skewed_files(size_t count, int thread_idx) {
-    std::string fname = "skewed_t" + std::to_string(thread_idx) + ".txt";
-    std::ofstream ofs(fname);
-    std::uniform_int_distribution<int> val_dist(1, 100);
-
-    for (size_t i = 0; i < count; ++i) {
-        if (rng() % 100 < 90) {
-            ofs << "write 0 " << val_dist(rng) << "\n";
-        }
-        else {
-            ofs << "string\n";
-        }
-    }
-}
-
-void run_test(const std::string& case_name, const std::string& file_prefix, int num_threads, MultiField& data) {
-    std::vector<std::vector<Op>> thread_ops(num_threads);
-
-    for (int i = 0; i < num_threads; ++i) {
-        thread_ops[i] = load_ops(file_prefix + "_t" + std::to_string(i) + ".txt");
-    }
-
-    auto start = std::chrono::steady_clock::now();
-
-    std::vector<std::thread> workers;
-    for (int i = 0; i < num_threads; ++i) {
-        workers.emplace_back(worker, std::ref(data), std::cref(thread_ops[i]));
-    }
-
-    for (auto& t : workers) t.join();
-
-    auto end = std::chrono::steady_clock::now();
-    std::chrono::duration<double> diff = end - start;
-
-    std::cout << "Case: " << std::setw(10) << case_name
-        << "Threads: " << num_threads
-        << "Time: " << diff.count() << " s" << std::endl;
-}
-
-int main() {
-    const int M = 3; 
-    const size_t OPS_PER_THREAD = 100000;
-    const int MAX_THREADS = 3;
-
-    std::cout << "Generating Files\n";
-    for (int i = 0; i < MAX_THREADS; ++i) {
-        generate_variant6_files(OPS_PER_THREAD, i);
-        generate_uniform_files(OPS_PER_THREAD, i, M);
-        generate_skewed_files(OPS_PER_THREAD, i);
-    }
-    std::cout << "Files generated.\n\n";
-
-    std::cout << "Starting Measurements\n";
-
-    for (int t = 1; t <= MAX_THREADS; ++t) {
-        MultiField data(M);
-        run_test("Variant 6", "var6", t, data);
-    }
-    std::cout << "\n";
-
-    for (int t = 1; t <= MAX_THREADS; ++t) {
-        MultiField data(M);
-        run_test("Uniform", "uniform", t, data);
-    }
-    std::cout << "\n";
-
-    for (int t = 1; t <= MAX_THREADS; ++t) {
-        MultiField data(M);
-        run_test("Skewed", "skewed", t, data);
-    }
-
-    return 0;
+#include <iostream>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <random>
+#include <chrono>
+#include <thread>
+#include <shared_mutex> 
+#include <mutex>
+#include <algorithm>
+#include <functional>
+#include <condition_variable>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include <cerrno>
+#include <cstring>
+#include <cmath>
+#include <iomanip>
+#include <atomic>
+#include <memory>
+#include <deque>
+#include <map>
+#include <array>
+#include <coroutine>
+#include <utility>
+#include <tuple>
+#include <cstdint>
+#include <cstdlib>
+#include <climits>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "multi_field.h"
+#include "recording_multi_field.h"
+#include "worker_pool.h"
+#include "op_runner.h"
+#include "traces.h"
+
+enum class Executor { Locking, Delegation, WorkStealing, Coroutine };
+
+const char* executor_name(Executor executor) {
+    switch (executor) {
+    case Executor::Locking: return "locking";
+    case Executor::Delegation: return "delegation";
+    case Executor::WorkStealing: return "work-stealing";
+    case Executor::Coroutine: return "coroutine";
+    }
+    return "unknown";
+}
+
+template <typename T>
+class SpscQueue {
+public:
+    explicit SpscQueue(size_t capacity) : buf(capacity), mask(capacity - 1) {}
+
+    bool try_push(const T& item) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head_cache == buf.size()) {
+            head_cache = head.load(std::memory_order_acquire);
+            if (t - head_cache == buf.size()) return false;
+        }
+        buf[t & mask] = item;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool try_pop(T& item) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail_cache) {
+            tail_cache = tail.load(std::memory_order_acquire);
+            if (h == tail_cache) return false;
+        }
+        item = buf[h & mask];
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    std::vector<T> buf;
+    size_t mask;
+    alignas(64) std::atomic<size_t> head{ 0 };
+    size_t tail_cache = 0;
+    alignas(64) std::atomic<size_t> tail{ 0 };
+    size_t head_cache = 0;
+};
+
+// Shared-nothing variant of MultiField: field idx belongs to thread idx % owners
+// and is only ever touched by that thread. Other threads delegate through
+// per-pair SPSC queues and serve their own inbox while they wait, so every
+// trace thread is both a client and an owner. STRING gathers each owner's
+// fields separately and is therefore not one atomic snapshot.
+class DelegatedMultiField {
+public:
+    DelegatedMultiField(size_t m, int owners)
+        : m(m), owners(owners), shards(owners), inboxes(owners * owners) {
+        for (int o = 0; o < owners; ++o) {
+            shards[o].assign((m + owners - 1 - o) / owners, 0);
+        }
+        for (auto& q : inboxes) {
+            q = std::make_unique<SpscQueue<Request>>(QUEUE_CAPACITY);
+        }
+    }
+
+    int read(int self, size_t idx) {
+        if (idx >= m) return 0;
+        int owner = static_cast<int>(idx % owners);
+        if (owner == self) return shards[self][idx / owners];
+        Reply reply;
+        reply.pending.store(1, std::memory_order_relaxed);
+        send(self, owner, { OpType::READ, idx, 0, &reply });
+        wait(self, reply);
+        return reply.value;
+    }
+
+    void write(int self, size_t idx, int value) {
+        if (idx >= m) return;
+        int owner = static_cast<int>(idx % owners);
+        if (owner == self) {
+            shards[self][idx / owners] = value;
+            return;
+        }
+        send(self, owner, { OpType::WRITE, idx, value, nullptr });
+    }
+
+    std::string to_string(int self) {
+        Reply reply;
+        reply.gathered.assign(m, 0);
+        reply.pending.store(owners - 1, std::memory_order_relaxed);
+        for (int o = 0; o < owners; ++o) {
+            if (o != self) send(self, o, { OpType::STRING, 0, 0, &reply });
+        }
+        gather(self, reply.gathered);
+        wait(self, reply);
+        return fields_to_string(reply.gathered);
+    }
+
+    void finish(int self) {
+        finished.fetch_add(1, std::memory_order_acq_rel);
+        while (finished.load(std::memory_order_acquire) < owners) {
+            if (!serve(self)) std::this_thread::yield();
+        }
+        serve(self);
+    }
+
+private:
+    static constexpr size_t QUEUE_CAPACITY = 1024;
+
+    struct Reply {
+        std::atomic<int> pending{ 0 };
+        int value = 0;
+        std::vector<int> gathered;
+    };
+
+    struct Request {
+        OpType type;
+        size_t idx;
+        int value;
+        Reply* reply;
+    };
+
+    SpscQueue<Request>& inbox(int from, int to) { return *inboxes[from * owners + to]; }
+
+    void send(int self, int owner, const Request& req) {
+        while (!inbox(self, owner).try_push(req)) {
+            if (!serve(self)) std::this_thread::yield();
+        }
+    }
+
+    void wait(int self, Reply& reply) {
+        while (reply.pending.load(std::memory_order_acquire) != 0) {
+            if (!serve(self)) std::this_thread::yield();
+        }
+    }
+
+    void gather(int self, std::vector<int>& out) const {
+        const auto& shard = shards[self];
+        for (size_t j = 0; j < shard.size(); ++j) {
+            out[j * owners + self] = shard[j];
+        }
+    }
+
+    bool serve(int self) {
+        bool served = false;
+        Request req;
+        for (int from = 0; from < owners; ++from) {
+            if (from == self) continue;
+            auto& q = inbox(from, self);
+            while (q.try_pop(req)) {
+                served = true;
+                switch (req.type) {
+                case OpType::READ:
+                    req.reply->value = shards[self][req.idx / owners];
+                    break;
+                case OpType::WRITE:
+                    shards[self][req.idx / owners] = req.value;
+                    break;
+                case OpType::STRING:
+                    gather(self, req.reply->gathered);
+                    break;
+                }
+                if (req.reply) req.reply->pending.fetch_sub(1, std::memory_order_release);
+            }
+        }
+        return served;
+    }
+
+    size_t m;
+    int owners;
+    std::vector<std::vector<int>> shards;
+    std::vector<std::unique_ptr<SpscQueue<Request>>> inboxes;
+    std::atomic<int> finished{ 0 };
+};
+
+// One completed operation as the calling thread saw it. A STRING result is
+// kept as m values starting at `snapshot` in the thread's snapshot buffer.
+struct HistoryEvent {
+    int64_t invoke_ns;
+    int64_t response_ns;
+    OpType type;
+    int idx;
+    int value;
+    size_t snapshot;
+};
+
+struct ThreadHistory {
+    std::vector<HistoryEvent> events;
+    std::vector<int> snapshots;
+    size_t m = 0;
+
+    void reserve(const std::vector<Op>& ops, size_t fields) {
+        m = fields;
+        events.reserve(ops.size());
+        size_t strings = std::count_if(ops.begin(), ops.end(), [](const Op& op) { return op.type == OpType::STRING; });
+        snapshots.reserve(strings * fields);
+    }
+};
+
+inline int64_t history_now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Parses the "{a, b, c}" form produced by to_string into `out`.
+inline void parse_fields(const std::string& s, size_t m, std::vector<int>& out) {
+    const char* p = s.c_str();
+    for (size_t k = 0; k < m; ++k) {
+        while (*p && *p != '-' && (*p < '0' || *p > '9')) ++p;
+        char* end = nullptr;
+        out.push_back(static_cast<int>(std::strtol(p, &end, 10)));
+        p = end;
+    }
+}
+
+// Recording variant of worker: stamps invocation and response of every op
+// into the preallocated history. Parsing a STRING result happens after the
+// response stamp, so it does not widen the op's interval.
+template <typename Field>
+void worker(Field& data, const std::vector<Op>& ops, ThreadHistory& history) {
+    for (const Op& op : ops) {
+        HistoryEvent e{ history_now_ns(), 0, op.type, op.idx, op.value, 0 };
+        switch (op.type) {
+        case OpType::READ:
+            e.value = data.read(op.idx);
+            e.response_ns = history_now_ns();
+            break;
+        case OpType::WRITE:
+            data.write(op.idx, op.value);
+            e.response_ns = history_now_ns();
+            break;
+        case OpType::STRING: {
+            std::string s = data.to_string();
+            e.response_ns = history_now_ns();
+            e.snapshot = history.snapshots.size();
+            parse_fields(s, history.m, history.snapshots);
+            break;
+        }
+        }
+        history.events.push_back(e);
+    }
+}
+
+struct OpChunk {
+    const Op* first;
+    const Op* last;
+};
+
+// Each trace is cut into chunks that start on its own thread's deque. Owners
+// take from the back, idle threads steal from the front of the other deques.
+class StealingDeques {
+public:
+    StealingDeques(const std::vector<std::vector<Op>>& thread_ops, size_t chunk_ops)
+        : lanes(thread_ops.size()) {
+        for (size_t t = 0; t < thread_ops.size(); ++t) {
+            const Op* base = thread_ops[t].data();
+            size_t n = thread_ops[t].size();
+            for (size_t i = 0; i < n; i += chunk_ops) {
+                lanes[t].chunks.push_back({ base + i, base + std::min(n, i + chunk_ops) });
+            }
+        }
+    }
+
+    bool pop(size_t self, OpChunk& chunk) {
+        Lane& lane = lanes[self];
+        std::lock_guard<std::mutex> lk(lane.mtx);
+        if (lane.chunks.empty()) return false;
+        chunk = lane.chunks.back();
+        lane.chunks.pop_back();
+        return true;
+    }
+
+    bool steal(size_t self, OpChunk& chunk) {
+        for (size_t k = 1; k < lanes.size(); ++k) {
+            Lane& lane = lanes[(self + k) % lanes.size()];
+            std::lock_guard<std::mutex> lk(lane.mtx);
+            if (lane.chunks.empty()) continue;
+            chunk = lane.chunks.front();
+            lane.chunks.pop_front();
+            return true;
+        }
+        return false;
+    }
+
+private:
+    struct alignas(64) Lane {
+        std::mutex mtx;
+        std::deque<OpChunk> chunks;
+    };
+
+    std::vector<Lane> lanes;
+};
+
+size_t stealing_worker(MultiField& data, StealingDeques& deques, size_t self, size_t& steals, OpLatency* latency) {
+    size_t done = 0;
+    OpChunk chunk;
+    while (true) {
+        if (!deques.pop(self, chunk)) {
+            if (!deques.steal(self, chunk)) break;
+            ++steals;
+        }
+        worker(data, chunk.first, chunk.last, latency);
+        done += chunk.last - chunk.first;
+    }
+    return done;
+}
+
+// Every awaitable takes a reference to the client's `worker` variable; the OS
+// thread that resumes the client stores its index there, so clients can keep
+// per-worker statistics without thread_local state, which is not safe to cache
+// across suspension points.
+class CoroScheduler {
+public:
+    void schedule(std::coroutine_handle<> h, size_t* worker) {
+        {
+            std::lock_guard<std::mutex> lk(mtx);
+            ready.push_back({ h, worker });
+        }
+        cv.notify_one();
+    }
+
+    void add_clients(size_t n) {
+        std::lock_guard<std::mutex> lk(mtx);
+        remaining += n;
+    }
+
+    void client_done() {
+        std::lock_guard<std::mutex> lk(mtx);
+        if (--remaining == 0) cv.notify_all();
+    }
+
+    void run_worker(size_t id) {
+        while (true) {
+            Ready r;
+            {
+                std::unique_lock<std::mutex> lk(mtx);
+                cv.wait(lk, [this] { return !ready.empty() || remaining == 0; });
+                if (ready.empty()) return;
+                r = ready.front();
+                ready.pop_front();
+            }
+            if (r.worker) *r.worker = id;
+            r.handle.resume();
+        }
+    }
+
+    auto yield(size_t& worker) {
+        struct Awaiter {
+            CoroScheduler& sched;
+            size_t& worker;
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> h) { sched.schedule(h, &worker); }
+            void await_resume() const noexcept {}
+        };
+        return Awaiter{ *this, worker };
+    }
+
+private:
+    struct Ready {
+        std::coroutine_handle<> handle;
+        size_t* worker;
+    };
+
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::deque<Ready> ready;
+    size_t remaining = 0;
+};
+
+class ClientTask {
+public:
+    struct promise_type {
+        CoroScheduler* sched = nullptr;
+
+        ClientTask get_return_object() {
+            return ClientTask(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        auto final_suspend() noexcept {
+            struct Done {
+                bool await_ready() const noexcept { return false; }
+                void await_suspend(std::coroutine_handle<promise_type> h) noexcept { h.promise().sched->client_done(); }
+                void await_resume() const noexcept {}
+            };
+            return Done{};
+        }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+
+    explicit ClientTask(std::coroutine_handle<promise_type> h) : handle(h) {}
+    ClientTask(ClientTask&& other) noexcept : handle(std::exchange(other.handle, {})) {}
+    ClientTask(const ClientTask&) = delete;
+    ClientTask& operator=(const ClientTask&) = delete;
+    ClientTask& operator=(ClientTask&&) = delete;
+    ~ClientTask() { if (handle) handle.destroy(); }
+
+    void start(CoroScheduler& sched) {
+        handle.promise().sched = &sched;
+        sched.schedule(handle, nullptr);
+    }
+
+private:
+    std::coroutine_handle<promise_type> handle;
+};
+
+// Reader-writer lock for coroutines: a client that cannot get the lock is
+// parked on the FIFO wait queue instead of blocking its OS thread, and is
+// handed back to the scheduler by whoever releases the lock.
+class AsyncSharedMutex {
+public:
+    auto lock_shared(CoroScheduler& sched, size_t& worker) { return Acquire{ *this, sched, worker, false }; }
+    auto lock(CoroScheduler& sched, size_t& worker) { return Acquire{ *this, sched, worker, true }; }
+
+    void unlock_shared() {
+        std::lock_guard<std::mutex> lk(mtx);
+        if (--readers == 0) wake_waiters();
+    }
+
+    void unlock() {
+        std::lock_guard<std::mutex> lk(mtx);
+        writer = false;
+        wake_waiters();
+    }
+
+private:
+    struct Waiter {
+        std::coroutine_handle<> handle;
+        size_t* worker;
+        bool exclusive;
+    };
+
+    struct Acquire {
+        AsyncSharedMutex& mtx;
+        CoroScheduler& sched;
+        size_t& worker;
+        bool exclusive;
+
+        bool await_ready() {
+            std::lock_guard<std::mutex> lk(mtx.mtx);
+            return mtx.try_acquire(exclusive);
+        }
+        bool await_suspend(std::coroutine_handle<> h) {
+            std::lock_guard<std::mutex> lk(mtx.mtx);
+            if (mtx.try_acquire(exclusive)) return false;
+            mtx.waiters.push_back({ h, &worker, exclusive });
+            mtx.sched = &sched;
+            return true;
+        }
+        void await_resume() const noexcept {}
+    };
+
+    bool try_acquire(bool exclusive) {
+        if (writer || !waiters.empty()) return false;
+        if (exclusive) {
+            if (readers != 0) return false;
+            writer = true;
+        }
+        else {
+            ++readers;
+        }
+        return true;
+    }
+
+    void wake_waiters() {
+        if (writer || readers != 0 || waiters.empty()) return;
+        if (waiters.front().exclusive) {
+            writer = true;
+            sched->schedule(waiters.front().handle, waiters.front().worker);
+            waiters.pop_front();
+            return;
+        }
+        while (!waiters.empty() && !waiters.front().exclusive) {
+            ++readers;
+            sched->schedule(waiters.front().handle, waiters.front().worker);
+            waiters.pop_front();
+        }
+    }
+
+    std::mutex mtx;
+    int readers = 0;
+    bool writer = false;
+    std::deque<Waiter> waiters;
+    CoroScheduler* sched = nullptr;
+};
+
+class CoroMultiField {
+public:
+    explicit CoroMultiField(size_t m) : vals(m, 0), locks(m) {}
+
+    size_t size() const { return vals.size(); }
+
+    std::vector<int> vals;
+    std::vector<AsyncSharedMutex> locks;
+};
+
+struct alignas(64) PaddedCounter {
+    size_t value = 0;
+};
+
+const size_t CORO_YIELD_EVERY = 64;
+
+ClientTask coro_client(CoroMultiField& data, CoroScheduler& sched, const Op* first, const Op* last,
+    std::vector<PaddedCounter>& ops_by_worker) {
+    size_t worker = 0;
+    co_await sched.yield(worker);
+    size_t issued = 0;
+    for (const Op* it = first; it != last; ++it) {
+        const Op& op = *it;
+        size_t idx = static_cast<size_t>(op.idx);
+        switch (op.type) {
+        case OpType::READ:
+            if (idx < data.size()) {
+                co_await data.locks[idx].lock_shared(sched, worker);
+                volatile int v = data.vals[idx];
+                (void)v;
+                data.locks[idx].unlock_shared();
+            }
+            break;
+        case OpType::WRITE:
+            if (idx < data.size()) {
+                co_await data.locks[idx].lock(sched, worker);
+                data.vals[idx] = op.value;
+                data.locks[idx].unlock();
+            }
+            break;
+        case OpType::STRING: {
+            for (auto& lk : data.locks) co_await lk.lock_shared(sched, worker);
+            std::string s = fields_to_string(data.vals);
+            for (auto& lk : data.locks) lk.unlock_shared();
+            volatile size_t len = s.length();
+            (void)len;
+            break;
+        }
+        }
+        ++ops_by_worker[worker].value;
+        if (++issued % CORO_YIELD_EVERY == 0) co_await sched.yield(worker);
+    }
+}
+
+void delegated_worker(DelegatedMultiField& data, int self, const std::vector<Op>& ops, OpLatency* latency) {
+    run_ops(ops.data(), ops.data() + ops.size(), latency, [&data, self](const Op& op) {
+        switch (op.type) {
+        case OpType::READ:
+            data.read(self, op.idx);
+            break;
+        case OpType::WRITE:
+            data.write(self, op.idx, op.value);
+            break;
+        case OpType::STRING: {
+            std::string s = data.to_string(self);
+            volatile size_t len = s.length();
+            (void)len;
+            break;
+        }
+        }
+        });
+    data.finish(self);
+}
+
+struct PerfValues {
+    static constexpr int COUNT = 4;
+    uint64_t values[COUNT] = {};
+    bool valid[COUNT] = {};
+
+    void merge(const PerfValues& other) {
+        for (int c = 0; c < COUNT; ++c) {
+            values[c] += other.values[c];
+            valid[c] = valid[c] || other.valid[c];
+        }
+    }
+};
+
+// Per-thread hardware counters via perf_event_open. Counters that the kernel
+// refuses (perf_event_paranoid, containers, missing PMU) are simply left out;
+// whatever could be opened is still reported.
+class PerfCounters {
+public:
+    PerfCounters() {
+        const std::pair<uint32_t, uint64_t> events[PerfValues::COUNT] = {
+            { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+            { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+            { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+            { PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES },
+        };
+        for (int c = 0; c < PerfValues::COUNT; ++c) {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = events[c].first;
+            attr.config = events[c].second;
+            attr.disabled = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            fds[c] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+            if (fds[c] < 0 && (errno == EACCES || errno == EPERM)) {
+                attr.exclude_kernel = 1;
+                fds[c] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+            }
+            if (fds[c] < 0) open_errno = errno;
+        }
+    }
+
+    ~PerfCounters() {
+        for (int fd : fds) if (fd >= 0) close(fd);
+    }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    bool any() const {
+        return std::any_of(std::begin(fds), std::end(fds), [](int fd) { return fd >= 0; });
+    }
+
+    int error() const { return open_errno; }
+
+    void start() {
+        for (int fd : fds) {
+            if (fd < 0) continue;
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+
+    PerfValues stop() {
+        PerfValues out;
+        for (int c = 0; c < PerfValues::COUNT; ++c) {
+            if (fds[c] < 0) continue;
+            ioctl(fds[c], PERF_EVENT_IOC_DISABLE, 0);
+            uint64_t buf[3];
+            if (read(fds[c], buf, sizeof(buf)) != sizeof(buf) || buf[2] == 0) continue;
+            out.values[c] = buf[2] < buf[1] ? static_cast<uint64_t>(double(buf[0]) * buf[1] / buf[2]) : buf[0];
+            out.valid[c] = true;
+        }
+        return out;
+    }
+
+private:
+    int fds[PerfValues::COUNT] = { -1, -1, -1, -1 };
+    int open_errno = 0;
+};
+
+void print_perf(const PerfValues& perf, size_t ops) {
+    const char* names[PerfValues::COUNT] = { "cycles", "instructions", "LLC-misses", "ctx-switches" };
+    if (ops == 0) return;
+    std::cout << "    perf per op:";
+    for (int c = 0; c < 3; ++c) {
+        if (perf.valid[c]) std::cout << " " << names[c] << "=" << double(perf.values[c]) / ops;
+    }
+    if (perf.valid[0] && perf.valid[1] && perf.values[0] > 0) {
+        std::cout << " IPC=" << double(perf.values[1]) / perf.values[0];
+    }
+    if (perf.valid[3]) std::cout << " " << names[3] << "=" << perf.values[3] << " total";
+    bool missing = false;
+    for (int c = 0; c < PerfValues::COUNT; ++c) {
+        if (perf.valid[c]) continue;
+        std::cout << (missing ? ", " : " (unavailable: ") << names[c];
+        missing = true;
+    }
+    std::cout << (missing ? ")\n" : "\n");
+}
+
+using Clock = std::chrono::steady_clock;
+
+class StartBarrier {
+public:
+    explicit StartBarrier(int parties) : waiting(parties) {}
+
+    void arrive_and_wait() {
+        if (waiting.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            released.store(true, std::memory_order_release);
+            return;
+        }
+        for (int spins = 0; !released.load(std::memory_order_acquire); ++spins) {
+            if (spins > 1000) std::this_thread::yield();
+        }
+    }
+
+private:
+    std::atomic<int> waiting;
+    std::atomic<bool> released{ false };
+};
+
+struct ThreadTiming {
+    Clock::time_point start;
+    Clock::time_point end;
+    size_t ops = 0;
+
+    double seconds() const { return std::chrono::duration<double>(end - start).count(); }
+};
+
+struct RunResult {
+    double seconds = 0;
+    size_t ops = 0;
+    std::vector<ThreadTiming> threads;
+    std::vector<size_t> steals;
+    OpLatency latency;
+    LockProfile locks;
+    PerfValues perf;
+    int perf_errno = 0;
+    size_t clients = 0;
+    size_t op_counts[3] = {};
+};
+
+void count_op_types(const std::vector<Op>& ops, size_t done, size_t counts[3]) {
+    if (ops.empty()) return;
+    size_t per_pass[3] = {};
+    for (const auto& op : ops) ++per_pass[static_cast<int>(op.type)];
+    size_t passes = done / ops.size();
+    for (int t = 0; t < 3; ++t) counts[t] += passes * per_pass[t];
+    for (size_t k = 0; k < done % ops.size(); ++k) ++counts[static_cast<int>(ops[k].type)];
+}
+
+RunResult summarize_timings(const std::vector<ThreadTiming>& timings) {
+    RunResult result;
+    result.threads = timings;
+    if (timings.empty()) return result;
+    auto first = timings[0].start;
+    auto last = timings[0].end;
+    for (const auto& t : timings) {
+        first = std::min(first, t.start);
+        last = std::max(last, t.end);
+        result.ops += t.ops;
+    }
+    result.seconds = std::chrono::duration<double>(last - first).count();
+    return result;
+}
+
+void print_lock_report(const LockProfile& profile, size_t top) {
+    std::vector<size_t> order;
+    for (size_t i = 0; i < profile.fields.size(); ++i) {
+        if (profile.fields[i].acquisitions > 0) order.push_back(i);
+    }
+    if (order.empty()) return;
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        const auto& fa = profile.fields[a];
+        const auto& fb = profile.fields[b];
+        return std::tie(fa.contended, fa.wait_ns) > std::tie(fb.contended, fb.wait_ns);
+        });
+    if (order.size() > top) order.resize(top);
+    std::cout << "    top contended fields:\n";
+    for (size_t i : order) {
+        const auto& f = profile.fields[i];
+        std::cout << "      field " << std::setw(4) << i
+            << " acquisitions " << f.acquisitions
+            << " contended " << f.contended
+            << " (" << std::fixed << std::setprecision(1) << 100.0 * f.contended / f.acquisitions << "%)"
+            << std::defaultfloat << std::setprecision(6)
+            << " wait " << f.wait_ns / 1000.0 << " us"
+            << " hold " << f.hold_ns / 1000.0 << " us\n";
+    }
+}
+
+void print_thread_timings(const RunResult& result) {
+    if (result.threads.size() < 2) return;
+    auto first = result.threads[0].start;
+    double total_busy = 0, max_busy = 0;
+    for (const auto& t : result.threads) {
+        first = std::min(first, t.start);
+        total_busy += t.seconds();
+        max_busy = std::max(max_busy, t.seconds());
+    }
+    for (size_t i = 0; i < result.threads.size(); ++i) {
+        const auto& t = result.threads[i];
+        std::cout << "    thread " << i
+            << " start +" << std::chrono::duration<double, std::micro>(t.start - first).count() << " us"
+            << " time " << t.seconds() << " s"
+            << " ops " << t.ops
+            << " (" << (t.seconds() > 0 ? t.ops / t.seconds() : 0) << " ops/s)\n";
+    }
+    double mean_busy = total_busy / result.threads.size();
+    std::cout << "    imbalance (max/mean busy time): " << (mean_busy > 0 ? max_busy / mean_busy : 1.0) << "\n";
+}
+
+struct RunConfig {
+    size_t steal_chunk_ops = 1024;
+    size_t coro_clients = 1000;
+    bool record_latency = false;
+    bool lock_stats = false;
+    size_t lock_report_top = 5;
+    bool perf_counters = false;
+    double duration_s = 0;
+    double interval_s = 0.5;
+    double warmup_s = 1.0;
+    int warmup_runs = 0;
+    int trials = 1;
+};
+
+RunResult measure_run(const std::vector<std::vector<Op>>& thread_ops, MultiField& data, WorkerPool& pool,
+    Executor executor, const RunConfig& cfg) {
+    int num_threads = static_cast<int>(thread_ops.size());
+
+    std::unique_ptr<DelegatedMultiField> delegated;
+    if (executor == Executor::Delegation) {
+        delegated = std::make_unique<DelegatedMultiField>(data.size(), num_threads);
+    }
+
+    std::unique_ptr<StealingDeques> deques;
+    if (executor == Executor::WorkStealing) {
+        deques = std::make_unique<StealingDeques>(thread_ops, cfg.steal_chunk_ops);
+    }
+
+    std::unique_ptr<CoroMultiField> coro_data;
+    CoroScheduler sched;
+    std::vector<ClientTask> clients;
+    std::vector<PaddedCounter> coro_ops(num_threads);
+    if (executor == Executor::Coroutine) {
+        coro_data = std::make_unique<CoroMultiField>(data.size());
+        size_t per_trace = std::max<size_t>(1, (cfg.coro_clients + num_threads - 1) / num_threads);
+        for (const auto& ops : thread_ops) {
+            for (size_t c = 0; c < per_trace; ++c) {
+                const Op* first = ops.data() + ops.size() * c / per_trace;
+                const Op* last = ops.data() + ops.size() * (c + 1) / per_trace;
+                clients.push_back(coro_client(*coro_data, sched, first, last, coro_ops));
+            }
+        }
+        sched.add_clients(clients.size());
+        for (auto& client : clients) client.start(sched);
+    }
+
+    StartBarrier barrier(num_threads);
+    std::vector<ThreadTiming> timings(num_threads);
+    std::vector<size_t> steals(num_threads, 0);
+    std::vector<OpLatency> latencies(cfg.record_latency ? num_threads : 0);
+    std::vector<LockProfile> lock_profiles(cfg.lock_stats ? num_threads : 0);
+    for (auto& p : lock_profiles) p.fields.resize(data.size());
+    std::vector<PerfValues> perf(num_threads);
+    std::atomic<int> perf_errno{ 0 };
+
+    pool.run(num_threads, [&](size_t i) {
+        if (!lock_profiles.empty()) lock_profile = &lock_profiles[i];
+        std::unique_ptr<PerfCounters> counters;
+        if (cfg.perf_counters) {
+            counters = std::make_unique<PerfCounters>();
+            if (!counters->any()) perf_errno.store(counters->error());
+        }
+        barrier.arrive_and_wait();
+        if (counters) counters->start();
+        timings[i].start = Clock::now();
+        size_t done = thread_ops[i].size();
+        OpLatency* latency = latencies.empty() ? nullptr : &latencies[i];
+        if (executor == Executor::Delegation) {
+            delegated_worker(*delegated, static_cast<int>(i), thread_ops[i], latency);
+        }
+        else if (executor == Executor::WorkStealing) {
+            done = stealing_worker(data, *deques, i, steals[i], latency);
+        }
+        else if (executor == Executor::Coroutine) {
+            sched.run_worker(i);
+            done = coro_ops[i].value;
+        }
+        else {
+            worker(data, thread_ops[i], latency);
+        }
+        timings[i].end = Clock::now();
+        if (counters) perf[i] = counters->stop();
+        timings[i].ops = done;
+        lock_profile = nullptr;
+        });
+
+    RunResult result = summarize_timings(timings);
+    if (executor == Executor::WorkStealing) result.steals = steals;
+    for (const auto& l : latencies) result.latency.merge(l);
+    for (const auto& p : lock_profiles) result.locks.merge(p);
+    for (const auto& p : perf) result.perf.merge(p);
+    result.clients = clients.size();
+    result.perf_errno = perf_errno.load();
+    for (const auto& ops : thread_ops) count_op_types(ops, ops.size(), result.op_counts);
+    return result;
+}
+
+void print_run(const std::string& case_name, int num_threads, Executor executor, const WorkerPool& pool,
+    const RunResult& result, const RunConfig& cfg) {
+    std::cout << "Case: " << std::setw(10) << case_name
+        << "Executor: " << std::setw(11) << executor_name(executor)
+        << "Placement: " << std::setw(8) << pool.placement()
+        << "Threads: " << num_threads
+        << "Time: " << result.seconds << " s"
+        << " Throughput: " << (result.seconds > 0 ? result.ops / result.seconds : 0) << " ops/s" << std::endl;
+    if (executor == Executor::Coroutine) std::cout << "    clients: " << result.clients << "\n";
+    print_thread_timings(result);
+    print_latency(result.latency);
+    print_lock_report(result.locks, cfg.lock_report_top);
+    if (cfg.perf_counters) {
+        if (result.perf_errno != 0) {
+            std::cout << "    perf counters unavailable: " << std::strerror(result.perf_errno)
+                << " (check /proc/sys/kernel/perf_event_paranoid)\n";
+        }
+        else {
+            print_perf(result.perf, result.ops);
+        }
+    }
+    if (!result.steals.empty() && num_threads > 1) {
+        std::cout << "    steals:";
+        for (size_t i = 0; i < result.steals.size(); ++i) std::cout << " t" << i << "=" << result.steals[i];
+        std::cout << "\n";
+    }
+}
+
+// Replays generated traces without storing them: every thread computes its
+// ops with op_at as it goes, so the measured time includes generating them.
+RunResult measure_lazy(const TraceGenerator& gen, int num_threads, MultiField& data, WorkerPool& pool,
+    const RunConfig& cfg) {
+    StartBarrier barrier(num_threads);
+    std::vector<ThreadTiming> timings(num_threads);
+    std::vector<OpLatency> latencies(cfg.record_latency ? num_threads : 0);
+    std::vector<std::array<size_t, 3>> counts(num_threads);
+    pool.run(num_threads, [&](size_t i) {
+        OpLatency* latency = latencies.empty() ? nullptr : &latencies[i];
+        std::array<size_t, 3> local = {};
+        barrier.arrive_and_wait();
+        timings[i].start = Clock::now();
+        for (uint64_t k = 0; k < gen.count; ++k) {
+            Op op = gen.op_at(k, static_cast<uint32_t>(i));
+            ++local[static_cast<int>(op.type)];
+            run_ops(&op, &op + 1, latency, [&data](const Op& o) { apply_op(data, o); });
+        }
+        timings[i].end = Clock::now();
+        timings[i].ops = gen.count;
+        counts[i] = local;
+        });
+    RunResult result = summarize_timings(timings);
+    for (const auto& l : latencies) result.latency.merge(l);
+    for (const auto& c : counts) {
+        for (int t = 0; t < 3; ++t) result.op_counts[t] += c[t];
+    }
+    return result;
+}
+
+RunResult run_test(const std::string& case_name, const std::string& file_prefix, int num_threads, MultiField& data,
+    WorkerPool& pool, Executor executor = Executor::Locking, const RunConfig& cfg = {}) {
+    const TraceGenerator* lazy = trace_catalog.source == TraceSource::Lazy ? trace_catalog.find(file_prefix) : nullptr;
+    if (lazy && executor == Executor::Locking && !cfg.lock_stats && !cfg.perf_counters) {
+        RunResult result = measure_lazy(*lazy, num_threads, data, pool, cfg);
+        print_run(case_name, num_threads, executor, pool, result, cfg);
+        return result;
+    }
+    std::vector<std::vector<Op>> thread_ops = load_traces(file_prefix, num_threads);
+    RunResult result = measure_run(thread_ops, data, pool, executor, cfg);
+    print_run(case_name, num_threads, executor, pool, result, cfg);
+    return result;
+}
+
+struct TrialStats {
+    size_t ops = 0;
+    size_t op_counts[3] = {};
+    size_t n = 0;
+    double mean = 0, median = 0, stddev = 0, min = 0, max = 0;
+    double ci95 = 0;
+    std::vector<size_t> outliers;
+    OpLatency latency;
+};
+
+double student_t95(size_t df) {
+    static const double table[] = { 12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+        2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+        2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042 };
+    if (df == 0) return 0;
+    return df <= std::size(table) ? table[df - 1] : 1.96;
+}
+
+double quantile_sorted(const std::vector<double>& sorted, double q) {
+    double pos = q * (sorted.size() - 1);
+    size_t lo = static_cast<size_t>(pos);
+    size_t hi = std::min(lo + 1, sorted.size() - 1);
+    return sorted[lo] + (sorted[hi] - sorted[lo]) * (pos - lo);
+}
+
+// Outliers use Tukey's fences (1.5 IQR beyond the quartiles), which needs at
+// least four samples to mean anything.
+TrialStats summarize_trials(const std::vector<double>& xs) {
+    TrialStats st;
+    st.n = xs.size();
+    if (xs.empty()) return st;
+    std::vector<double> sorted = xs;
+    std::sort(sorted.begin(), sorted.end());
+    double sum = 0;
+    for (double x : xs) sum += x;
+    st.mean = sum / st.n;
+    st.median = quantile_sorted(sorted, 0.5);
+    st.min = sorted.front();
+    st.max = sorted.back();
+    if (st.n > 1) {
+        double sq = 0;
+        for (double x : xs) sq += (x - st.mean) * (x - st.mean);
+        st.stddev = std::sqrt(sq / (st.n - 1));
+        st.ci95 = student_t95(st.n - 1) * st.stddev / std::sqrt(double(st.n));
+    }
+    if (st.n >= 4) {
+        double q1 = quantile_sorted(sorted, 0.25);
+        double q3 = quantile_sorted(sorted, 0.75);
+        double iqr = q3 - q1;
+        for (size_t i = 0; i < xs.size(); ++i) {
+            if (xs[i] < q1 - 1.5 * iqr || xs[i] > q3 + 1.5 * iqr) st.outliers.push_back(i);
+        }
+    }
+    return st;
+}
+
+TrialStats run_trials(const std::string& case_name, const std::string& file_prefix, int num_threads, size_t m,
+    WorkerPool& pool, Executor executor, const RunConfig& cfg) {
+    std::vector<std::vector<Op>> thread_ops = load_traces(file_prefix, num_threads);
+    for (int w = 0; w < cfg.warmup_runs; ++w) {
+        MultiField data(m);
+        measure_run(thread_ops, data, pool, executor, cfg);
+    }
+    std::vector<double> seconds;
+    RunResult last;
+    OpLatency latency;
+    for (int k = 0; k < cfg.trials; ++k) {
+        MultiField data(m);
+        last = measure_run(thread_ops, data, pool, executor, cfg);
+        seconds.push_back(last.seconds);
+        latency.merge(last.latency);
+    }
+    TrialStats st = summarize_trials(seconds);
+    st.latency = latency;
+    size_t ops = last.ops;
+    st.ops = ops;
+    std::copy(std::begin(last.op_counts), std::end(last.op_counts), st.op_counts);
+
+    std::cout << "Case: " << std::setw(10) << case_name
+        << "Executor: " << std::setw(11) << executor_name(executor)
+        << "Placement: " << std::setw(8) << pool.placement()
+        << "Threads: " << num_threads
+        << "Trials: " << st.n << " (+" << cfg.warmup_runs << " warmup)" << std::endl;
+    std::cout << "    time mean " << st.mean << " s median " << st.median << " s stddev " << st.stddev
+        << " s min " << st.min << " s max " << st.max << " s\n";
+    std::cout << "    95% CI " << st.mean << " +/- " << st.ci95 << " s ("
+        << std::fixed << std::setprecision(1) << (st.mean > 0 ? 100.0 * st.ci95 / st.mean : 0) << "%)"
+        << std::defaultfloat << std::setprecision(6)
+        << ", median throughput " << (st.median > 0 ? ops / st.median : 0) << " ops/s\n";
+    if (!st.outliers.empty()) {
+        std::cout << "    outliers:";
+        for (size_t i : st.outliers) std::cout << " trial " << i << " (" << seconds[i] << " s)";
+        std::cout << "\n";
+    }
+    if (cfg.record_latency) print_latency(st.latency);
+    return st;
+}
+
+const size_t TIMED_CHECK_OPS = 256;
+
+// Time-bounded variant of run_test for the locking executor: every worker
+// replays its trace in a loop until the duration expires, publishing its op
+// count every TIMED_CHECK_OPS ops so a sampler thread can record throughput
+// per interval without touching the hot path.
+RunResult run_timed(const std::string& case_name, const std::string& file_prefix, int num_threads, MultiField& data,
+    WorkerPool& pool, const RunConfig& cfg) {
+    std::vector<std::vector<Op>> thread_ops = load_traces(file_prefix, num_threads);
+
+    struct alignas(64) Progress {
+        std::atomic<size_t> ops{ 0 };
+    };
+    std::vector<Progress> progress(num_threads);
+    std::vector<ThreadTiming> timings(num_threads);
+    std::vector<OpLatency> latencies(cfg.record_latency ? num_threads : 0);
+    std::vector<LockProfile> lock_profiles(cfg.lock_stats ? num_threads : 0);
+    for (auto& p : lock_profiles) p.fields.resize(data.size());
+    std::atomic<bool> stop{ false };
+    StartBarrier barrier(num_threads + 1);
+
+    struct Sample {
+        double t;
+        size_t ops;
+    };
+    std::vector<Sample> samples;
+    std::thread sampler([&] {
+        barrier.arrive_and_wait();
+        auto start = Clock::now();
+        auto interval = std::chrono::duration<double>(cfg.interval_s);
+        auto deadline = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(cfg.duration_s));
+        samples.push_back({ 0.0, 0 });
+        for (auto next = start + std::chrono::duration_cast<Clock::duration>(interval); ;
+            next += std::chrono::duration_cast<Clock::duration>(interval)) {
+            if (next > deadline) next = deadline;
+            std::this_thread::sleep_until(next);
+            size_t total = 0;
+            for (auto& p : progress) total += p.ops.load(std::memory_order_relaxed);
+            samples.push_back({ std::chrono::duration<double>(Clock::now() - start).count(), total });
+            if (next >= deadline) break;
+        }
+        stop.store(true, std::memory_order_relaxed);
+        });
+
+    pool.run(num_threads, [&](size_t i) {
+        if (!lock_profiles.empty()) lock_profile = &lock_profiles[i];
+        OpLatency* latency = latencies.empty() ? nullptr : &latencies[i];
+        const auto& ops = thread_ops[i];
+        barrier.arrive_and_wait();
+        timings[i].start = Clock::now();
+        size_t done = 0;
+        size_t pos = 0;
+        while (!ops.empty() && !stop.load(std::memory_order_relaxed)) {
+            size_t n = std::min(TIMED_CHECK_OPS, ops.size() - pos);
+            worker(data, ops.data() + pos, ops.data() + pos + n, latency);
+            pos = (pos + n) % ops.size();
+            done += n;
+            progress[i].ops.store(done, std::memory_order_relaxed);
+        }
+        timings[i].end = Clock::now();
+        timings[i].ops = done;
+        lock_profile = nullptr;
+        });
+    sampler.join();
+
+    RunResult result = summarize_timings(timings);
+    for (const auto& l : latencies) result.latency.merge(l);
+    for (const auto& p : lock_profiles) result.locks.merge(p);
+    for (int i = 0; i < num_threads; ++i) count_op_types(thread_ops[i], timings[i].ops, result.op_counts);
+
+    std::cout << "Case: " << std::setw(10) << case_name
+        << "Executor: " << std::setw(11) << executor_name(Executor::Locking)
+        << "Placement: " << std::setw(8) << pool.placement()
+        << "Threads: " << num_threads
+        << "Duration: " << result.seconds << " s"
+        << " Ops: " << result.ops
+        << " Throughput: " << (result.seconds > 0 ? result.ops / result.seconds : 0) << " ops/s" << std::endl;
+
+    std::cout << "    interval throughput (ops/s):";
+    for (size_t k = 1; k < samples.size(); ++k) {
+        double dt = samples[k].t - samples[k - 1].t;
+        if (dt <= 0) continue;
+        std::cout << (k % 8 == 1 ? "\n      " : " ")
+            << std::fixed << std::setprecision(2) << samples[k].t << "s:" << std::defaultfloat << std::setprecision(6)
+            << (samples[k].ops - samples[k - 1].ops) / dt;
+    }
+    std::cout << "\n";
+
+    auto warm = std::find_if(samples.begin(), samples.end(), [&](const Sample& x) { return x.t >= cfg.warmup_s; });
+    if (warm != samples.end() && samples.back().t > warm->t) {
+        double steady = (samples.back().ops - warm->ops) / (samples.back().t - warm->t);
+        std::cout << "    steady-state throughput after " << warm->t << " s warmup: " << steady << " ops/s\n";
+    }
+    else {
+        std::cout << "    steady-state throughput: run shorter than the " << cfg.warmup_s << " s warmup\n";
+    }
+    print_thread_timings(result);
+    print_latency(result.latency);
+    print_lock_report(result.locks, cfg.lock_report_top);
+    return result;
+}
+
+struct OpenLoopConfig {
+    double start_rate = 100000;
+    double rate_factor = 2;
+    int max_steps = 12;
+    double seconds_per_rate = 1.0;
+    double knee_p99_us = 1000;
+};
+
+struct OpenLoopResult {
+    double target_rate = 0;
+    double achieved_rate = 0;
+    size_t ops = 0;
+    double p50_us = 0, p90_us = 0, p99_us = 0, p999_us = 0, max_us = 0;
+    OpLatency latency;
+};
+
+// Ops are issued on a fixed global schedule: op k of thread t is due at
+// start + (k * threads + t) / rate, whether or not earlier ops have finished.
+// Latency is measured from that due time rather than from the actual send, so
+// time spent queued behind a slow op is counted (no coordinated omission).
+OpenLoopResult run_open_loop(const std::vector<std::vector<Op>>& thread_ops, MultiField& data, WorkerPool& pool,
+    double rate, double seconds) {
+    int num_threads = static_cast<int>(thread_ops.size());
+    size_t per_thread = std::max<size_t>(1, static_cast<size_t>(rate * seconds / num_threads));
+    std::vector<OpLatency> latencies(num_threads);
+    std::vector<ThreadTiming> timings(num_threads);
+    StartBarrier barrier(num_threads);
+    Clock::time_point start;
+    std::atomic<bool> start_set{ false };
+
+    pool.run(num_threads, [&](size_t i) {
+        barrier.arrive_and_wait();
+        if (i == 0) {
+            start = Clock::now() + std::chrono::microseconds(100);
+            start_set.store(true, std::memory_order_release);
+        }
+        while (!start_set.load(std::memory_order_acquire)) std::this_thread::yield();
+        const auto& ops = thread_ops[i];
+        timings[i].start = start;
+        size_t k = 0;
+        for (; k < per_thread && !ops.empty(); ++k) {
+            auto due = start + std::chrono::nanoseconds(
+                static_cast<int64_t>((k * num_threads + i) * 1e9 / rate));
+            auto now = Clock::now();
+            while (now < due) {
+                if (due - now > std::chrono::microseconds(200)) {
+                    std::this_thread::sleep_for(due - now - std::chrono::microseconds(100));
+                }
+                now = Clock::now();
+            }
+            const Op& op = ops[k % ops.size()];
+            apply_op(data, op);
+            latencies[i].record(op.type, std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - due).count());
+        }
+        timings[i].end = Clock::now();
+        timings[i].ops = k;
+        });
+
+    RunResult run = summarize_timings(timings);
+    OpenLoopResult result;
+    for (const auto& l : latencies) result.latency.merge(l);
+    LatencyHistogram all;
+    for (const auto& h : result.latency.by_type) all.merge(h);
+
+    result.target_rate = rate;
+    result.ops = run.ops;
+    result.achieved_rate = run.seconds > 0 ? run.ops / run.seconds : 0;
+    result.p50_us = all.percentile(0.5) / 1000.0;
+    result.p90_us = all.percentile(0.9) / 1000.0;
+    result.p99_us = all.percentile(0.99) / 1000.0;
+    result.p999_us = all.percentile(0.999) / 1000.0;
+    result.max_us = all.max() / 1000.0;
+    return result;
+}
+
+std::vector<OpenLoopResult> sweep_open_loop(const std::string& case_name, const std::string& file_prefix,
+    int num_threads, size_t m, WorkerPool& pool, const OpenLoopConfig& cfg) {
+    std::vector<std::vector<Op>> thread_ops = load_traces(file_prefix, num_threads);
+
+    std::cout << "Open loop: " << case_name << ", " << num_threads << " threads\n";
+    std::cout << std::setw(14) << "target ops/s" << std::setw(14) << "achieved"
+        << std::setw(11) << "p50 us" << std::setw(11) << "p90 us" << std::setw(11) << "p99 us"
+        << std::setw(11) << "p99.9 us" << std::setw(11) << "max us" << "\n";
+
+    std::vector<OpenLoopResult> results;
+    double knee = 0;
+    double rate = cfg.start_rate;
+    for (int step = 0; step < cfg.max_steps; ++step, rate *= cfg.rate_factor) {
+        MultiField data(m);
+        OpenLoopResult r = run_open_loop(thread_ops, data, pool, rate, cfg.seconds_per_rate);
+        results.push_back(r);
+        std::cout << std::setw(14) << r.target_rate << std::setw(14) << r.achieved_rate
+            << std::setw(11) << r.p50_us << std::setw(11) << r.p90_us << std::setw(11) << r.p99_us
+            << std::setw(11) << r.p999_us << std::setw(11) << r.max_us << "\n";
+        bool saturated = r.achieved_rate < 0.95 * r.target_rate || r.p99_us > cfg.knee_p99_us;
+        if (saturated) break;
+        knee = rate;
+    }
+    if (knee > 0) {
+        std::cout << "Saturation knee: ~" << knee << " ops/s (last rate with achieved >= 95% of target and p99 <= "
+            << cfg.knee_p99_us << " us)\n\n";
+    }
+    else {
+        std::cout << "Saturated already at " << cfg.start_rate << " ops/s; lower --rate-start\n\n";
+    }
+    return results;
+}
+
+std::vector<int> scaling_points(int cores, const std::vector<double>& oversubscription) {
+    std::vector<int> points;
+    for (int t = 1; t <= cores; ++t) points.push_back(t);
+    for (double f : oversubscription) {
+        int t = static_cast<int>(std::lround(f * cores));
+        if (t > points.back()) points.push_back(t);
+    }
+    return points;
+}
+
+struct ScalingPoint {
+    int threads;
+    RunResult result;
+};
+
+// Every thread replays its own full trace, so this is weak scaling: the total
+// work grows with the thread count and speedup is a throughput ratio against
+// the single-thread run. Efficiency divides by the threads that can actually
+// run at once, so oversubscribed points (marked *) are judged against the
+// core count rather than the thread count.
+std::vector<ScalingPoint> run_scaling(const std::string& case_name, const std::string& file_prefix,
+    const std::vector<int>& points, int cores, size_t m, WorkerPool& pool, Executor executor, const RunConfig& cfg) {
+    std::vector<std::vector<Op>> all_ops = load_traces(file_prefix, points.back());
+    std::vector<ScalingPoint> out;
+    for (int t : points) {
+        std::vector<std::vector<Op>> thread_ops(all_ops.begin(), all_ops.begin() + t);
+        RunResult best;
+        for (int k = 0; k < cfg.warmup_runs + cfg.trials; ++k) {
+            MultiField data(m);
+            RunResult r = measure_run(thread_ops, data, pool, executor, cfg);
+            if (k < cfg.warmup_runs) continue;
+            if (best.seconds == 0 || r.seconds < best.seconds) best = std::move(r);
+        }
+        out.push_back({ t, std::move(best) });
+    }
+
+    std::cout << "Scaling: " << case_name << ", executor " << executor_name(executor)
+        << ", placement " << pool.placement() << ", " << cores << " cores"
+        << (cfg.trials > 1 ? " (best of " + std::to_string(cfg.trials) + " trials)" : "") << "\n";
+    std::cout << std::setw(9) << "threads" << std::setw(13) << "time s" << std::setw(15) << "ops/s"
+        << std::setw(10) << "speedup" << std::setw(12) << "efficiency" << "\n";
+    double base = 0;
+    for (const auto& pt : out) {
+        double tput = pt.result.seconds > 0 ? pt.result.ops / pt.result.seconds : 0;
+        if (pt.threads == 1) base = tput;
+        double speedup = base > 0 ? tput / base : 0;
+        double efficiency = speedup / std::min(pt.threads, cores);
+        std::cout << std::setw(8) << pt.threads << (pt.threads > cores ? "*" : " ")
+            << std::setw(13) << pt.result.seconds << std::setw(15) << tput
+            << std::fixed << std::setprecision(2)
+            << std::setw(10) << speedup << std::setw(11) << 100 * efficiency << "%"
+            << std::defaultfloat << std::setprecision(6) << "\n";
+    }
+    std::cout << "\n";
+    return out;
+}
+
+template <typename Field>
+RunResult measure_backend(const std::vector<std::vector<Op>>& thread_ops, Field& data, WorkerPool& pool,
+    bool record_latency) {
+    int num_threads = static_cast<int>(thread_ops.size());
+    StartBarrier barrier(num_threads);
+    std::vector<ThreadTiming> timings(num_threads);
+    std::vector<OpLatency> latencies(record_latency ? num_threads : 0);
+    pool.run(num_threads, [&](size_t i) {
+        barrier.arrive_and_wait();
+        timings[i].start = Clock::now();
+        worker(data, thread_ops[i], latencies.empty() ? nullptr : &latencies[i]);
+        timings[i].end = Clock::now();
+        timings[i].ops = thread_ops[i].size();
+        });
+    RunResult result = summarize_timings(timings);
+    for (const auto& l : latencies) result.latency.merge(l);
+    for (const auto& ops : thread_ops) count_op_types(ops, ops.size(), result.op_counts);
+    return result;
+}
+
+// Gives every write a distinct non-zero value, so each read value names
+// exactly one write (0 stays the initial value of every field).
+std::vector<std::vector<Op>> with_unique_writes(const std::vector<std::vector<Op>>& thread_ops) {
+    std::vector<std::vector<Op>> traces = thread_ops;
+    int n = static_cast<int>(traces.size());
+    for (int t = 0; t < n; ++t) {
+        int seq = 0;
+        for (auto& op : traces[t]) {
+            if (op.type == OpType::WRITE) op.value = seq++ * n + t + 1;
+        }
+    }
+    return traces;
+}
+
+struct HistoryCheck {
+    size_t events = 0;
+    size_t violations = 0;
+    std::vector<std::string> details;
+    double seconds = 0;
+};
+
+// Checks each field as an independent read/write register, following Gibbons
+// and Korach: with unique write values, a history is linearizable iff every
+// read returns a value that was written and does not finish before that write
+// starts, the forward zones of the value clusters are pairwise disjoint, and
+// no backward zone lies inside a forward zone. The initial 0 is a write at
+// -inf. A STRING counts as a read of every field over its interval, so this
+// verifies per-field linearizability, not that to_string is an atomic
+// snapshot across fields.
+HistoryCheck check_linearizable(const std::vector<ThreadHistory>& histories, size_t m) {
+    struct Cluster {
+        bool written = false;
+        int64_t write_invoke = 0;
+        int64_t min_read_response = INT64_MAX;
+        int64_t min_response = INT64_MAX;
+        int64_t max_invoke = INT64_MIN;
+    };
+    struct Zone {
+        int64_t lo;
+        int64_t hi;
+        int value;
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    HistoryCheck check;
+    auto report = [&check](const std::string& what) {
+        if (check.details.size() < 5) check.details.push_back(what);
+        ++check.violations;
+    };
+
+    std::vector<std::unordered_map<int, Cluster>> fields(m);
+    for (auto& f : fields) {
+        Cluster& init = f[0];
+        init.written = true;
+        init.write_invoke = INT64_MIN;
+        init.min_response = INT64_MIN;
+    }
+    auto add_read = [](Cluster& c, const HistoryEvent& e) {
+        c.min_read_response = std::min(c.min_read_response, e.response_ns);
+        c.min_response = std::min(c.min_response, e.response_ns);
+        c.max_invoke = std::max(c.max_invoke, e.invoke_ns);
+    };
+    for (const auto& h : histories) {
+        check.events += h.events.size();
+        for (const auto& e : h.events) {
+            if (e.type == OpType::STRING) {
+                for (size_t k = 0; k < m; ++k) add_read(fields[k][h.snapshots[e.snapshot + k]], e);
+                continue;
+            }
+            if (e.idx < 0 || static_cast<size_t>(e.idx) >= m) continue;
+            Cluster& c = fields[e.idx][e.value];
+            if (e.type == OpType::READ) {
+                add_read(c, e);
+                continue;
+            }
+            c.written = true;
+            c.write_invoke = e.invoke_ns;
+            c.min_response = std::min(c.min_response, e.response_ns);
+            c.max_invoke = std::max(c.max_invoke, e.invoke_ns);
+        }
+    }
+
+    for (size_t f = 0; f < m; ++f) {
+        std::vector<Zone> forward;
+        std::vector<Zone> backward;
+        for (const auto& [value, c] : fields[f]) {
+            std::string where = "field " + std::to_string(f) + " value " + std::to_string(value);
+            if (!c.written) {
+                report(where + ": read a value that was never written");
+                continue;
+            }
+            if (c.min_read_response < c.write_invoke) {
+                report(where + ": read returned before its write started");
+            }
+            if (c.min_response < c.max_invoke) forward.push_back({ c.min_response, c.max_invoke, value });
+            else backward.push_back({ c.max_invoke, c.min_response, value });
+        }
+
+        std::sort(forward.begin(), forward.end(), [](const Zone& a, const Zone& b) { return a.lo < b.lo; });
+        for (size_t i = 1; i < forward.size(); ++i) {
+            if (forward[i].lo < forward[i - 1].hi) {
+                report("field " + std::to_string(f) + ": values " + std::to_string(forward[i - 1].value) + " and "
+                    + std::to_string(forward[i].value) + " are each forced to be current over the same interval");
+            }
+        }
+        for (const auto& b : backward) {
+            auto it = std::upper_bound(forward.begin(), forward.end(), b.lo,
+                [](int64_t lo, const Zone& z) { return lo <= z.lo; });
+            if (it == forward.begin()) continue;
+            --it;
+            if (b.hi < it->hi) {
+                report("field " + std::to_string(f) + ": value " + std::to_string(b.value)
+                    + " was current only while value " + std::to_string(it->value) + " had to be");
+            }
+        }
+    }
+    check.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return check;
+}
+
+template <typename Field>
+HistoryCheck record_and_check(const std::vector<std::vector<Op>>& thread_ops, size_t m, WorkerPool& pool) {
+    std::vector<std::vector<Op>> traces = with_unique_writes(thread_ops);
+    int num_threads = static_cast<int>(traces.size());
+    std::vector<ThreadHistory> histories(num_threads);
+    for (int i = 0; i < num_threads; ++i) histories[i].reserve(traces[i], m);
+    Field data(m);
+    StartBarrier barrier(num_threads);
+    pool.run(num_threads, [&](size_t i) {
+        barrier.arrive_and_wait();
+        worker(data, traces[i], histories[i]);
+        });
+    return check_linearizable(histories, m);
+}
+
+// Per-thread ops of every phase, indexed [phase][thread]. Op-count phases get
+// exactly their ops; timed phases get cycle_ops that are replayed until the
+// phase's time is up.
+std::vector<std::vector<std::vector<Op>>> build_phase_traces(const PhasedConfig& cfg, int num_threads,
+    uint64_t seed, int gen_threads) {
+    std::vector<std::vector<std::vector<Op>>> traces;
+    for (size_t p = 0; p < cfg.phases.size(); ++p) {
+        const Phase& phase = cfg.phases[p];
+        size_t count = phase.seconds > 0 ? cfg.cycle_ops : phase.ops;
+        TraceGenerator gen = phase_trace(phase, cfg.m, count, seed, 16 + static_cast<uint32_t>(p));
+        traces.push_back(materialize_traces(gen, num_threads, gen_threads, 1 << 14));
+    }
+    return traces;
+}
+
+// Runs the phases back to back on one Field without stopping between them,
+// so the backend sees every transition under load. Each thread times each
+// phase on its own; a timed phase ends `seconds` after that thread entered
+// it. Returns one RunResult per phase.
+template <typename Field>
+std::vector<RunResult> run_phases(const PhasedConfig& cfg, const std::vector<std::vector<std::vector<Op>>>& traces,
+    int num_threads, WorkerPool& pool, bool record_latency) {
+    size_t phases = cfg.phases.size();
+    Field data(cfg.m);
+    StartBarrier barrier(num_threads);
+    std::vector<std::vector<ThreadTiming>> timings(phases, std::vector<ThreadTiming>(num_threads));
+    std::vector<std::vector<OpLatency>> latencies(record_latency ? phases : 0, std::vector<OpLatency>(num_threads));
+    pool.run(num_threads, [&](size_t i) {
+        barrier.arrive_and_wait();
+        for (size_t p = 0; p < phases; ++p) {
+            const std::vector<Op>& ops = traces[p][i];
+            OpLatency* latency = record_latency ? &latencies[p][i] : nullptr;
+            ThreadTiming& timing = timings[p][i];
+            timing.start = Clock::now();
+            if (cfg.phases[p].seconds > 0) {
+                auto deadline = timing.start + std::chrono::duration_cast<Clock::duration>(
+                    std::chrono::duration<double>(cfg.phases[p].seconds));
+                size_t pos = 0;
+                do {
+                    size_t n = std::min(TIMED_CHECK_OPS, ops.size() - pos);
+                    worker(data, ops.data() + pos, ops.data() + pos + n, latency);
+                    timing.ops += n;
+                    pos += n;
+                    if (pos == ops.size()) pos = 0;
+                } while (Clock::now() < deadline);
+            }
+            else {
+                worker(data, ops, latency);
+                timing.ops = ops.size();
+            }
+            timing.end = Clock::now();
+        }
+        });
+
+    std::vector<RunResult> results;
+    for (size_t p = 0; p < phases; ++p) {
+        RunResult r = summarize_timings(timings[p]);
+        for (int i = 0; i < num_threads; ++i) count_op_types(traces[p][i], timings[p][i].ops, r.op_counts);
+        if (record_latency) {
+            for (const auto& l : latencies[p]) r.latency.merge(l);
+        }
+        results.push_back(std::move(r));
+    }
+    return results;
+}
+
+struct BackendRun {
+    RunResult result;
+    std::string final_state;
+};
+
+struct Backend {
+    const char* name;
+    std::function<BackendRun(const std::vector<std::vector<Op>>&, size_t, WorkerPool&, bool)> run;
+    std::function<HistoryCheck(const std::vector<std::vector<Op>>&, size_t, WorkerPool&)> check;
+    std::function<std::vector<RunResult>(const PhasedConfig&, const std::vector<std::vector<std::vector<Op>>>&, int,
+        WorkerPool&, bool)> phased;
+};
+
+template <typename Field>
+Backend make_backend(const char* name) {
+    return { name, [](const std::vector<std::vector<Op>>& thread_ops, size_t m, WorkerPool& pool, bool record_latency) {
+        Field data(m);
+        BackendRun run;
+        run.result = measure_backend(thread_ops, data, pool, record_latency);
+        run.final_state = data.to_string();
+        return run;
+    }, record_and_check<Field>, run_phases<Field> };
+}
+
+std::vector<Backend> all_backends() {
+    return {
+        make_backend<MultiField>("shared_mutex"),
+        make_backend<MutexMultiField>("mutex"),
+        make_backend<GlobalLockMultiField>("global-lock"),
+        make_backend<SeqlockMultiField>("seqlock"),
+        make_backend<AtomicMultiField>("atomic"),
+    };
+}
+
+struct Workload {
+    std::string name;
+    std::string prefix;
+    std::string separator;
+    size_t m;
+};
+
+struct CompareCell {
+    std::string workload;
+    std::string backend;
+    int threads;
+    size_t m;
+    RunResult result;
+    LatencyHistogram latency;
+};
+
+// Runs every backend on the same in-memory copy of each workload's traces.
+// Each cell is measured twice: once untimed for throughput and once with
+// per-op timing for the latency matrix, so the clock reads do not distort the
+// throughput numbers. A single-threaded replay of trace 0 must leave every
+// backend in the same final state.
+std::vector<CompareCell> compare_backends(const std::vector<Workload>& workloads, const std::vector<Backend>& backends,
+    int max_threads, WorkerPool& pool) {
+    std::vector<CompareCell> cells;
+    for (const auto& w : workloads) {
+        std::vector<std::vector<Op>> traces = load_traces(w.prefix, max_threads, w.separator);
+        if (std::any_of(traces.begin(), traces.end(), [](const std::vector<Op>& t) { return t.empty(); })) {
+            std::cout << "Skipping " << w.name << ": missing " << w.prefix << w.separator << "* traces\n\n";
+            continue;
+        }
+
+        std::cout << "Workload: " << w.name << " (m=" << w.m << ")\n";
+        std::string reference;
+        bool agree = true;
+        for (const auto& b : backends) {
+            std::string state = b.run({ traces[0] }, w.m, pool, false).final_state;
+            if (reference.empty()) reference = state;
+            else if (state != reference) {
+                agree = false;
+                std::cout << "    final state MISMATCH: " << b.name << " " << state.substr(0, 120)
+                    << " vs " << backends[0].name << " " << reference.substr(0, 120) << "\n";
+            }
+        }
+        if (agree) std::cout << "    single-threaded final state: all " << backends.size() << " backends agree\n";
+
+        std::vector<CompareCell> rows;
+        for (int t = 1; t <= max_threads; ++t) {
+            std::vector<std::vector<Op>> thread_ops(traces.begin(), traces.begin() + t);
+            for (const auto& b : backends) {
+                CompareCell cell{ w.name, b.name, t, w.m, b.run(thread_ops, w.m, pool, false).result, {} };
+                BackendRun timed = b.run(thread_ops, w.m, pool, true);
+                for (const auto& h : timed.result.latency.by_type) cell.latency.merge(h);
+                cell.result.latency = timed.result.latency;
+                rows.push_back(std::move(cell));
+            }
+        }
+
+        std::cout << "    throughput, Mops/s\n" << std::setw(12) << "threads";
+        for (const auto& b : backends) std::cout << std::setw(14) << b.name;
+        std::cout << "\n";
+        for (int t = 1; t <= max_threads; ++t) {
+            std::cout << std::setw(12) << t;
+            for (const auto& c : rows) {
+                if (c.threads != t) continue;
+                std::cout << std::fixed << std::setprecision(2) << std::setw(14)
+                    << (c.result.seconds > 0 ? c.result.ops / c.result.seconds / 1e6 : 0)
+                    << std::defaultfloat << std::setprecision(6);
+            }
+            std::cout << "\n";
+        }
+        std::cout << "    latency p50 / p99, ns (all op types)\n" << std::setw(12) << "threads";
+        for (const auto& b : backends) std::cout << std::setw(14) << b.name;
+        std::cout << "\n";
+        for (int t = 1; t <= max_threads; ++t) {
+            std::cout << std::setw(12) << t;
+            for (const auto& c : rows) {
+                if (c.threads != t) continue;
+                std::ostringstream cell;
+                cell << c.latency.percentile(0.5) << " / " << c.latency.percentile(0.99);
+                std::cout << std::setw(14) << cell.str();
+            }
+            std::cout << "\n";
+        }
+        std::cout << "\n";
+        cells.insert(cells.end(), rows.begin(), rows.end());
+    }
+    return cells;
+}
+
+// Records a history of every backend on each workload and checks it offline.
+// Returns false if any backend produced a non-linearizable history.
+bool check_backends(const std::vector<Workload>& workloads, const std::vector<Backend>& backends,
+    int num_threads, WorkerPool& pool) {
+    bool ok = true;
+    for (const auto& w : workloads) {
+        std::vector<std::vector<Op>> traces = load_traces(w.prefix, num_threads, w.separator);
+        if (std::any_of(traces.begin(), traces.end(), [](const std::vector<Op>& t) { return t.empty(); })) {
+            std::cout << "Skipping " << w.name << ": missing " << w.prefix << w.separator << "* traces\n\n";
+            continue;
+        }
+        std::cout << "Workload: " << w.name << " (m=" << w.m << ", " << num_threads << " threads)\n";
+        for (const auto& b : backends) {
+            HistoryCheck c = b.check(traces, w.m, pool);
+            std::cout << "    " << std::left << std::setw(14) << b.name << std::right
+                << (c.violations == 0 ? "linearizable" : "NOT linearizable") << ", " << c.events << " events, "
+                << c.violations << " violations, checked in " << std::fixed << std::setprecision(1)
+                << c.seconds * 1000 << " ms" << std::defaultfloat << std::setprecision(6) << "\n";
+            for (const auto& d : c.details) std::cout << "        " << d << "\n";
+            if (c.violations > 0) ok = false;
+        }
+        std::cout << "\n";
+    }
+    return ok;
+}
+
+bool same_ops(const std::vector<Op>& a, const std::vector<Op>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i].type != b[i].type || (a[i].type != OpType::STRING && a[i].idx != b[i].idx)
+            || (a[i].type == OpType::WRITE && a[i].value != b[i].value)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Cost of RecordingMultiField on the closed-loop path: median time of
+// `trials` runs without capture, with text capture and with binary capture,
+// interleaved so drift hits all three alike. The overhead is end to end: when
+// there is no spare core for the flusher, its work is part of the cost. The
+// single-thread captures are read back and compared with the input trace.
+void measure_capture_overhead(const std::string& case_name, const std::string& prefix, int max_threads, size_t m,
+    WorkerPool& pool, int trials) {
+    std::vector<std::vector<Op>> traces = load_traces(prefix, max_threads);
+    int cores = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    std::cout << "Capture overhead: " << case_name << ", median of " << trials << " runs, " << cores << " cores\n";
+    std::cout << std::setw(8) << "threads" << std::setw(12) << "base Mops/s" << std::setw(12) << "text Mops/s"
+        << std::setw(8) << "text %" << std::setw(12) << "bin Mops/s" << std::setw(8) << "bin %"
+        << std::setw(8) << "stalls" << "\n";
+    auto capture_run = [&](const std::vector<std::vector<Op>>& thread_ops, TraceFormat format, const char* name,
+        std::vector<double>& seconds, size_t& stalls) {
+        TraceCapture capture(name, format);
+        RecordingMultiField<> data(m, capture);
+        seconds.push_back(measure_backend(thread_ops, data, pool, false).seconds);
+        capture.stop();
+        stalls += capture.stalls();
+    };
+    auto pct = [](double x, double base) { return base > 0 ? 100.0 * (x - base) / base : 0; };
+    for (int t = 1; t <= max_threads; ++t) {
+        std::vector<std::vector<Op>> thread_ops(traces.begin(), traces.begin() + t);
+        std::vector<double> base, text, binary;
+        size_t stalls = 0;
+        for (int k = 0; k < trials; ++k) {
+            MultiField plain(m);
+            base.push_back(measure_backend(thread_ops, plain, pool, false).seconds);
+            capture_run(thread_ops, TraceFormat::Text, "capture_text", text, stalls);
+            capture_run(thread_ops, TraceFormat::Binary, "capture_bin", binary, stalls);
+        }
+        size_t ops = 0;
+        for (const auto& o : thread_ops) ops += o.size();
+        double b = summarize_trials(base).median;
+        double x = summarize_trials(text).median;
+        double y = summarize_trials(binary).median;
+        std::cout << std::setw(8) << t << std::fixed << std::setprecision(2)
+            << std::setw(12) << ops / b / 1e6 << std::setw(12) << ops / x / 1e6 << std::setprecision(1)
+            << std::setw(8) << pct(x, b) << std::setprecision(2) << std::setw(12) << ops / y / 1e6
+            << std::setprecision(1) << std::setw(8) << pct(y, b) << std::defaultfloat << std::setprecision(6)
+            << std::setw(8) << stalls << "\n";
+        if (t == 1) {
+            std::vector<std::vector<Op>> from_binary;
+            bool text_ok = same_ops(load_ops("capture_text_t0.txt"), thread_ops[0]);
+            bool binary_ok = load_binary_trace("capture_bin.bin", from_binary) && from_binary.size() == 1
+                && same_ops(from_binary[0], thread_ops[0]);
+            std::cout << "    replay check: text capture " << (text_ok ? "matches" : "DIFFERS FROM")
+                << " the input trace, binary capture " << (binary_ok ? "matches" : "DIFFERS FROM") << " it\n";
+        }
+    }
+    if (max_threads >= cores) {
+        std::cout << "    rows with " << cores << "+ threads: the flusher shares a core with the workers\n";
+    }
+    std::cout << "\n";
+}
+
+void print_phases(const PhasedConfig& cfg, const char* backend, int num_threads, const std::vector<RunResult>& results,
+    bool record_latency) {
+    std::cout << "Phased workload: backend " << backend << ", m=" << cfg.m << ", " << num_threads << " threads\n";
+    std::cout << "    " << std::left << std::setw(16) << "phase" << std::right << std::setw(10) << "mix r/w/s"
+        << std::setw(12) << "ops" << std::setw(10) << "seconds" << std::setw(10) << "Mops/s";
+    if (record_latency) std::cout << std::setw(10) << "p50 ns" << std::setw(10) << "p99 ns";
+    std::cout << "\n";
+    for (size_t p = 0; p < results.size(); ++p) {
+        const Phase& phase = cfg.phases[p];
+        const RunResult& r = results[p];
+        std::ostringstream mix;
+        mix << phase.read_pct << "/" << phase.write_pct << "/" << 100 - phase.read_pct - phase.write_pct;
+        std::cout << "    " << std::left << std::setw(16) << phase.name << std::right << std::setw(10) << mix.str()
+            << std::setw(12) << r.ops << std::fixed << std::setprecision(3) << std::setw(10) << r.seconds
+            << std::setprecision(2) << std::setw(10) << (r.seconds > 0 ? r.ops / r.seconds / 1e6 : 0)
+            << std::defaultfloat << std::setprecision(6);
+        if (record_latency) {
+            LatencyHistogram all;
+            for (const auto& h : r.latency.by_type) all.merge(h);
+            std::cout << std::setw(10) << all.percentile(0.5) << std::setw(10) << all.percentile(0.99);
+        }
+        std::cout << "\n";
+    }
+    std::cout << "\n";
+}
+
+#ifndef LAB4_CXXFLAGS
+#define LAB4_CXXFLAGS "unknown"
+#endif
+
+struct HostInfo {
+    std::string cpu_model = "unknown";
+    unsigned cores = std::thread::hardware_concurrency();
+    std::string compiler;
+    std::string flags = LAB4_CXXFLAGS;
+
+    HostInfo() {
+        std::ifstream ifs("/proc/cpuinfo");
+        std::string line;
+        while (std::getline(ifs, line)) {
+            if (line.rfind("model name", 0) != 0) continue;
+            size_t colon = line.find(':');
+            if (colon != std::string::npos) cpu_model = line.substr(line.find_first_not_of(' ', colon + 1));
+            break;
+        }
+#if defined(__clang__)
+        compiler = "clang " __clang_version__;
+#elif defined(__GNUC__)
+        compiler = "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+        compiler = "msvc " + std::to_string(_MSC_VER);
+#endif
+#ifdef __OPTIMIZE__
+        if (flags == "unknown") flags = "optimized";
+#endif
+    }
+};
+
+// One row per measured cell. Fields that a mode does not produce (latency
+// without --latency, trial statistics outside --trials, target rate outside
+// --open-loop) are left empty in CSV and null in JSON.
+struct ResultRecord {
+    std::string mode;
+    std::string case_name;
+    std::string backend = "shared_mutex";
+    std::string executor;
+    std::string placement;
+    int threads = 0;
+    size_t m = 0;
+    size_t op_counts[3] = {};
+    size_t ops = 0;
+    double seconds = 0;
+    double throughput = 0;
+    bool has_latency = false;
+    uint64_t latency[3][5] = {};
+    bool has_trials = false;
+    size_t trials = 0;
+    double mean = 0, median = 0, stddev = 0, ci95 = 0;
+    bool has_rate = false;
+    double target_rate = 0;
+};
+
+void fill_latency(ResultRecord& rec, const OpLatency& latency) {
+    const double qs[4] = { 0.5, 0.9, 0.99, 0.999 };
+    for (int t = 0; t < 3; ++t) {
+        const auto& h = latency.by_type[t];
+        if (h.count() == 0) continue;
+        rec.has_latency = true;
+        for (int q = 0; q < 4; ++q) rec.latency[t][q] = h.percentile(qs[q]);
+        rec.latency[t][4] = h.max();
+    }
+}
+
+std::string json_escape(const std::string& text) {
+    std::string out;
+    for (char c : text) {
+        switch (c) {
+        case '"': out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n"; break;
+        case '\t': out += "\\t"; break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                std::ostringstream oss;
+                oss << "\\u" << std::hex << std::setw(4) << std::setfill('0') << int(c);
+                out += oss.str();
+            }
+            else {
+                out += c;
+            }
+        }
+    }
+    return out;
+}
+
+std::string csv_field(const std::string& text) {
+    if (text.find_first_of(",\"\n") == std::string::npos) return text;
+    std::string out = "\"";
+    for (char c : text) {
+        if (c == '"') out += '"';
+        out += c;
+    }
+    return out + "\"";
+}
+
+class ResultSink {
+public:
+    void add(const ResultRecord& rec) { records.push_back(rec); }
+
+    bool write_csv(const std::string& path) const {
+        std::ofstream ofs(path);
+        if (!ofs) {
+            std::cerr << "Cannot write " << path << "\n";
+            return false;
+        }
+        ofs << "mode,case,backend,executor,placement,threads,m,reads,writes,strings,ops,seconds,throughput";
+        for (const char* type : OP_NAMES) {
+            for (const char* q : QUANTILE_NAMES) ofs << "," << type << "_" << q << "_ns";
+        }
+        ofs << ",trials,mean_s,median_s,stddev_s,ci95_s,target_rate,cpu_model,cores,compiler,flags\n";
+        ofs << std::setprecision(9);
+        for (const auto& r : records) {
+            ofs << csv_field(r.mode) << "," << csv_field(r.case_name) << "," << csv_field(r.backend) << ","
+                << csv_field(r.executor) << ","
+                << csv_field(r.placement) << "," << r.threads << "," << r.m << ","
+                << r.op_counts[0] << "," << r.op_counts[1] << "," << r.op_counts[2] << ","
+                << r.ops << "," << r.seconds << "," << r.throughput;
+            for (int t = 0; t < 3; ++t) {
+                for (int q = 0; q < 5; ++q) {
+                    ofs << ",";
+                    if (r.has_latency) ofs << r.latency[t][q];
+                }
+            }
+            ofs << ",";
+            if (r.has_trials) ofs << r.trials << "," << r.mean << "," << r.median << "," << r.stddev << "," << r.ci95;
+            else ofs << ",,,,";
+            ofs << ",";
+            if (r.has_rate) ofs << r.target_rate;
+            ofs << "," << csv_field(host.cpu_model) << "," << host.cores << ","
+                << csv_field(host.compiler) << "," << csv_field(host.flags) << "\n";
+        }
+        return true;
+    }
+
+    bool write_json(const std::string& path) const {
+        std::ofstream ofs(path);
+        if (!ofs) {
+            std::cerr << "Cannot write " << path << "\n";
+            return false;
+        }
+        std::ostringstream host_json;
+        host_json << "{\"cpu_model\": \"" << json_escape(host.cpu_model) << "\", \"cores\": " << host.cores
+            << ", \"compiler\": \"" << json_escape(host.compiler) << "\", \"flags\": \"" << json_escape(host.flags) << "\"}";
+        ofs << std::setprecision(9);
+        ofs << "[\n";
+        for (size_t i = 0; i < records.size(); ++i) {
+            const auto& r = records[i];
+            ofs << "  {\"mode\": \"" << json_escape(r.mode) << "\", \"case\": \"" << json_escape(r.case_name)
+                << "\", \"backend\": \"" << json_escape(r.backend) << "\", \"executor\": \"" << json_escape(r.executor) << "\", \"placement\": \"" << json_escape(r.placement)
+                << "\", \"threads\": " << r.threads << ", \"m\": " << r.m
+                << ", \"reads\": " << r.op_counts[0] << ", \"writes\": " << r.op_counts[1]
+                << ", \"strings\": " << r.op_counts[2] << ", \"ops\": " << r.ops
+                << ", \"seconds\": " << r.seconds << ", \"throughput\": " << r.throughput;
+            ofs << ", \"latency_ns\": ";
+            if (r.has_latency) {
+                ofs << "{";
+                for (int t = 0; t < 3; ++t) {
+                    ofs << (t ? ", " : "") << "\"" << OP_NAMES[t] << "\": {";
+                    for (int q = 0; q < 5; ++q) {
+                        ofs << (q ? ", " : "") << "\"" << QUANTILE_NAMES[q] << "\": " << r.latency[t][q];
+                    }
+                    ofs << "}";
+                }
+                ofs << "}";
+            }
+            else {
+                ofs << "null";
+            }
+            ofs << ", \"trials\": ";
+            if (r.has_trials) {
+                ofs << "{\"n\": " << r.trials << ", \"mean_s\": " << r.mean << ", \"median_s\": " << r.median
+                    << ", \"stddev_s\": " << r.stddev << ", \"ci95_s\": " << r.ci95 << "}";
+            }
+            else {
+                ofs << "null";
+            }
+            ofs << ", \"target_rate\": ";
+            if (r.has_rate) ofs << r.target_rate;
+            else ofs << "null";
+            ofs << ", \"host\": " << host_json.str() << "}" << (i + 1 < records.size() ? "," : "") << "\n";
+        }
+        ofs << "]\n";
+        return true;
+    }
+
+private:
+    static constexpr const char* OP_NAMES[3] = { "read", "write", "string" };
+    static constexpr const char* QUANTILE_NAMES[5] = { "p50", "p90", "p99", "p999", "max" };
+
+    HostInfo host;
+    std::vector<ResultRecord> records;
+};
+
+ResultRecord make_record(const std::string& mode, const std::string& case_name, Executor executor,
+    const WorkerPool& pool, int threads, size_t m, const RunResult& r) {
+    ResultRecord rec;
+    rec.mode = mode;
+    rec.case_name = case_name;
+    rec.executor = executor_name(executor);
+    rec.placement = pool.placement();
+    rec.threads = threads;
+    rec.m = m;
+    std::copy(std::begin(r.op_counts), std::end(r.op_counts), rec.op_counts);
+    rec.ops = r.ops;
+    rec.seconds = r.seconds;
+    rec.throughput = r.seconds > 0 ? r.ops / r.seconds : 0;
+    fill_latency(rec, r.latency);
+    return rec;
+}
+
+struct BenchOptions {
+    PlacementPolicy placement;
+    std::vector<Executor> executors = { Executor::Locking, Executor::Delegation };
+    RunConfig exec;
+    bool open_loop = false;
+    OpenLoopConfig open_loop_cfg;
+    std::string csv_path;
+    std::string json_path;
+    bool compare = false;
+    bool check_history = false;
+    bool phased = false;
+    PhasedConfig phased_cfg;
+    bool capture_overhead = false;
+    bool demo = false;
+    std::vector<std::string> backends;
+    TraceGenConfig gen;
+    bool seed_set = false;
+    size_t trace_ops = 100000;
+    TraceSource trace_source = TraceSource::Memory;
+    bool export_traces = false;
+    std::string spec_path;
+    bool keyed = false;
+    KeyedTraceConfig keyed_cfg;
+    std::vector<double> thetas;
+    bool scaling = false;
+    int scaling_cores = 0;
+    std::vector<double> oversubscription = { 1.5, 2.0 };
+};
+
+bool parse_executors(const std::string& text, std::vector<Executor>& executors) {
+    const Executor all[] = { Executor::Locking, Executor::Delegation, Executor::WorkStealing, Executor::Coroutine };
+    executors.clear();
+    std::istringstream iss(text);
+    std::string name;
+    while (std::getline(iss, name, ',')) {
+        auto it = std::find_if(std::begin(all), std::end(all),
+            [&](Executor e) { return name == executor_name(e); });
+        if (it == std::end(all)) return false;
+        executors.push_back(*it);
+    }
+    return !executors.empty();
+}
+
+// std::stoul accepts "-5" and wraps it around, and stops at the first
+// non-digit; counts and seeds must be plain non-negative numbers.
+unsigned long long parse_unsigned(const std::string& text) {
+    size_t used = 0;
+    unsigned long long v = std::stoull(text, &used);
+    if (text.find('-') != std::string::npos || used != text.size()) throw std::invalid_argument(text);
+    return v;
+}
+
+bool parse_options(int argc, char** argv, BenchOptions& opts) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        try {
+            if (arg.rfind("--placement=", 0) == 0) {
+                if (!parse_placement(arg.substr(12), opts.placement)) {
+                    std::cerr << "Bad placement: " << arg.substr(12)
+                        << " (expected none, compact, scatter, no-smt or list:<cpus>)\n";
+                    return false;
+                }
+            }
+            else if (arg.rfind("--executors=", 0) == 0) {
+                if (!parse_executors(arg.substr(12), opts.executors)) {
+                    std::cerr << "Bad executor list: " << arg.substr(12)
+                        << " (expected a comma-separated list of locking, delegation, work-stealing, coroutine)\n";
+                    return false;
+                }
+            }
+            else if (arg.rfind("--steal-chunk=", 0) == 0) {
+                opts.exec.steal_chunk_ops = std::max<size_t>(1, parse_unsigned(arg.substr(14)));
+            }
+            else if (arg.rfind("--clients=", 0) == 0) {
+                opts.exec.coro_clients = std::max<size_t>(1, parse_unsigned(arg.substr(10)));
+            }
+            else if (arg == "--latency") {
+                opts.exec.record_latency = true;
+            }
+            else if (arg == "--lock-stats") {
+                opts.exec.lock_stats = true;
+            }
+            else if (arg.rfind("--lock-stats-top=", 0) == 0) {
+                opts.exec.lock_stats = true;
+                opts.exec.lock_report_top = parse_unsigned(arg.substr(17));
+            }
+            else if (arg == "--perf") {
+                opts.exec.perf_counters = true;
+            }
+            else if (arg.rfind("--duration=", 0) == 0) {
+                opts.exec.duration_s = std::stod(arg.substr(11));
+                if (!(opts.exec.duration_s > 0)) {
+                    std::cerr << "Bad duration: " << arg.substr(11) << " (expected seconds > 0)\n";
+                    return false;
+                }
+            }
+            else if (arg.rfind("--interval=", 0) == 0) {
+                opts.exec.interval_s = std::stod(arg.substr(11));
+                if (!(opts.exec.interval_s > 0)) {
+                    std::cerr << "Bad interval: " << arg.substr(11) << " (expected seconds > 0)\n";
+                    return false;
+                }
+            }
+            else if (arg.rfind("--warmup=", 0) == 0) {
+                opts.exec.warmup_s = std::stod(arg.substr(9));
+                if (!(opts.exec.warmup_s >= 0)) {
+                    std::cerr << "Bad warmup: " << arg.substr(9) << " (expected seconds >= 0)\n";
+                    return false;
+                }
+            }
+            else if (arg.rfind("--trials=", 0) == 0) {
+                opts.exec.trials = std::max(1, std::stoi(arg.substr(9)));
+            }
+            else if (arg.rfind("--warmup-runs=", 0) == 0) {
+                opts.exec.warmup_runs = std::max(0, std::stoi(arg.substr(14)));
+            }
+            else if (arg.rfind("--csv=", 0) == 0) {
+                opts.csv_path = arg.substr(6);
+            }
+            else if (arg.rfind("--json=", 0) == 0) {
+                opts.json_path = arg.substr(7);
+            }
+            else if (arg == "--compare") {
+                opts.compare = true;
+            }
+            else if (arg.rfind("--seed=", 0) == 0) {
+                opts.gen.seed = parse_unsigned(arg.substr(7));
+                opts.seed_set = true;
+            }
+            else if (arg.rfind("--gen-threads=", 0) == 0) {
+                opts.gen.threads = std::max(1, std::stoi(arg.substr(14)));
+            }
+            else if (arg.rfind("--trace-source=", 0) == 0) {
+                std::string source = arg.substr(15);
+                if (source == "file") opts.trace_source = TraceSource::File;
+                else if (source == "memory") opts.trace_source = TraceSource::Memory;
+                else if (source == "lazy") opts.trace_source = TraceSource::Lazy;
+                else {
+                    std::cerr << "Bad trace source: " << source << " (expected file, memory or lazy)\n";
+                    return false;
+                }
+            }
+            else if (arg.rfind("--spec=", 0) == 0) {
+                opts.spec_path = arg.substr(7);
+            }
+            else if (arg == "--export-traces") {
+                opts.export_traces = true;
+            }
+            else if (arg.rfind("--trace-ops=", 0) == 0) {
+                opts.trace_ops = std::max<size_t>(1, parse_unsigned(arg.substr(12)));
+            }
+            else if (arg.rfind("--dist=", 0) == 0) {
+                if (!parse_field_dist(arg.substr(7), opts.keyed_cfg.dist.kind)) {
+                    std::cerr << "Bad distribution: " << arg.substr(7)
+                        << " (expected uniform, zipf, scrambled-zipf, hotspot or latest)\n";
+                    return false;
+                }
+                opts.keyed = true;
+            }
+            else if (arg.rfind("--theta=", 0) == 0) {
+                std::istringstream iss(arg.substr(8));
+                std::string item;
+                opts.thetas.clear();
+                while (std::getline(iss, item, ',')) {
+                    double theta = std::stod(item);
+                    if (theta < 0 || theta >= 1) {
+                        std::cerr << "Bad theta: " << item << " (expected 0 <= theta < 1)\n";
+                        return false;
+                    }
+                    opts.thetas.push_back(theta);
+                }
+                opts.keyed = true;
+            }
+            else if (arg.rfind("--dist-m=", 0) == 0) {
+                opts.keyed_cfg.m = std::max<size_t>(1, parse_unsigned(arg.substr(9)));
+                opts.keyed = true;
+            }
+            else if (arg.rfind("--hot-fraction=", 0) == 0) {
+                opts.keyed_cfg.dist.hot_fraction = std::clamp(std::stod(arg.substr(15)), 0.0, 1.0);
+            }
+            else if (arg.rfind("--hot-ops=", 0) == 0) {
+                opts.keyed_cfg.dist.hot_ops = std::clamp(std::stod(arg.substr(10)), 0.0, 1.0);
+            }
+            else if (arg.rfind("--latest-shift=", 0) == 0) {
+                opts.keyed_cfg.dist.latest_shift_ops = std::max<size_t>(1, parse_unsigned(arg.substr(15)));
+            }
+            else if (arg.rfind("--mix=", 0) == 0) {
+                char sep1 = 0;
+                std::istringstream iss(arg.substr(6));
+                if (!(iss >> opts.keyed_cfg.read_pct >> sep1 >> opts.keyed_cfg.write_pct) || sep1 != '/'
+                    || opts.keyed_cfg.read_pct < 0 || opts.keyed_cfg.write_pct < 0
+                    || opts.keyed_cfg.read_pct + opts.keyed_cfg.write_pct > 100) {
+                    std::cerr << "Bad mix: " << arg.substr(6) << " (expected <read%>/<write%>, strings get the rest)\n";
+                    return false;
+                }
+            }
+            else if (arg == "--capture-overhead") {
+                opts.capture_overhead = true;
+            }
+            else if (arg == "--demo") {
+                opts.demo = true;
+            }
+            else if (arg == "--phased") {
+                opts.phased = true;
+            }
+            else if (arg.rfind("--phases=", 0) == 0) {
+                if (!parse_phases(arg.substr(9), opts.phased_cfg.phases)) {
+                    std::cerr << "Bad phase list: " << arg.substr(9) << "\n";
+                    return false;
+                }
+                opts.phased = true;
+            }
+            else if (arg.rfind("--phase-m=", 0) == 0) {
+                opts.phased_cfg.m = std::max<size_t>(1, parse_unsigned(arg.substr(10)));
+            }
+            else if (arg == "--check-history") {
+                opts.check_history = true;
+            }
+            else if (arg.rfind("--backends=", 0) == 0) {
+                std::istringstream iss(arg.substr(11));
+                std::string name;
+                while (std::getline(iss, name, ',')) {
+                    if (!name.empty()) opts.backends.push_back(name);
+                }
+            }
+            else if (arg == "--scaling") {
+                opts.scaling = true;
+            }
+            else if (arg.rfind("--scaling-cores=", 0) == 0) {
+                opts.scaling = true;
+                opts.scaling_cores = std::max(1, std::stoi(arg.substr(16)));
+            }
+            else if (arg.rfind("--oversubscribe=", 0) == 0) {
+                opts.oversubscription.clear();
+                std::istringstream iss(arg.substr(16));
+                std::string factor;
+                while (std::getline(iss, factor, ',')) {
+                    if (!factor.empty()) opts.oversubscription.push_back(std::stod(factor));
+                }
+            }
+            else if (arg == "--open-loop") {
+                opts.open_loop = true;
+            }
+            else if (arg.rfind("--rate-start=", 0) == 0) {
+                opts.open_loop_cfg.start_rate = std::stod(arg.substr(13));
+                if (!(opts.open_loop_cfg.start_rate > 0)) {
+                    std::cerr << "Bad start rate: " << arg.substr(13) << " (expected ops/s > 0)\n";
+                    return false;
+                }
+            }
+            else if (arg.rfind("--rate-steps=", 0) == 0) {
+                opts.open_loop_cfg.max_steps = std::stoi(arg.substr(13));
+                if (opts.open_loop_cfg.max_steps < 1) {
+                    std::cerr << "Bad rate steps: " << arg.substr(13) << " (expected >= 1)\n";
+                    return false;
+                }
+            }
+            else if (arg.rfind("--rate-seconds=", 0) == 0) {
+                opts.open_loop_cfg.seconds_per_rate = std::stod(arg.substr(15));
+                if (!(opts.open_loop_cfg.seconds_per_rate > 0)) {
+                    std::cerr << "Bad rate seconds: " << arg.substr(15) << " (expected seconds > 0)\n";
+                    return false;
+                }
+            }
+            else if (arg.rfind("--knee-p99-us=", 0) == 0) {
+                opts.open_loop_cfg.knee_p99_us = std::stod(arg.substr(14));
+            }
+            else {
+                std::cerr << "Unknown option: " << arg << "\n";
+                return false;
+            }
+        }
+        catch (const std::exception&) {
+            size_t eq = arg.find('=');
+            std::cerr << "Bad value for " << arg.substr(0, eq) << ": " << arg.substr(eq + 1) << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+struct SpecCase {
+    std::string name;
+    std::string generator = "uniform";
+    size_t m = 3;
+    int m_line = 0;
+    KeyedTraceConfig keyed;
+    std::string prefix;
+    std::string separator = "_t";
+};
+
+// A benchmark campaign read from a spec file: the cases, the backends, the
+// thread counts and how often to repeat every cell.
+struct WorkloadSpec {
+    bool seed_set = false;
+    uint64_t seed = 0;
+    size_t ops = 100000;
+    std::vector<int> threads = { 1, 2, 3 };
+    int trials = 3;
+    int warmup_runs = 1;
+    bool record_latency = false;
+    std::vector<std::string> backends;
+    std::string csv_path;
+    std::string json_path;
+    std::vector<SpecCase> cases;
+    PhasedConfig phased;
+};
+
+std::string trim(const std::string& text) {
+    size_t first = text.find_first_not_of(" \t\r");
+    if (first == std::string::npos) return "";
+    size_t last = text.find_last_not_of(" \t\r");
+    return text.substr(first, last - first + 1);
+}
+
+// INI-style: [run], [case <name>] and [phase <name>] sections holding
+// key = value lines; '#' starts a comment. Phase sections take the same
+// settings as --phases and run as one phased workload after the cases.
+bool load_spec(const std::string& path, WorkloadSpec& spec) {
+    std::ifstream ifs(path);
+    if (!ifs) {
+        std::cerr << "Cannot open spec: " << path << "\n";
+        return false;
+    }
+    std::string section;
+    std::string line;
+    std::string error;
+    int line_no = 0;
+    int phase_line = 0;
+    auto fail_at = [&](int at, const std::string& what) {
+        std::cerr << path << ":" << at << ": " << what << "\n";
+        return false;
+    };
+    auto fail = [&](const std::string& what) { return fail_at(line_no, what); };
+    // A phase is complete once the next section starts or the file ends.
+    auto finish_phase = [&] {
+        if (section != "phase" || check_phase(spec.phased.phases.back(), error)) return true;
+        return fail_at(phase_line, error);
+    };
+    while (std::getline(ifs, line)) {
+        ++line_no;
+        line = trim(line.substr(0, line.find('#')));
+        if (line.empty()) continue;
+        if (line.front() == '[') {
+            if (line.back() != ']') return fail("unterminated section header");
+            if (!finish_phase()) return false;
+            std::string header = trim(line.substr(1, line.size() - 2));
+            std::string kind = header.substr(0, header.find(' '));
+            std::string name = header.find(' ') == std::string::npos ? "" : trim(header.substr(header.find(' ')));
+            if (kind == "case") {
+                if (name.empty()) return fail("case needs a name");
+                spec.cases.push_back(SpecCase());
+                spec.cases.back().name = name;
+            }
+            else if (kind == "phase") {
+                if (name.empty()) return fail("phase needs a name");
+                spec.phased.phases.push_back(Phase());
+                spec.phased.phases.back().name = name;
+                phase_line = line_no;
+            }
+            else if (kind != "run") {
+                return fail("unknown section [" + header + "]");
+            }
+            section = kind;
+            continue;
+        }
+        size_t eq = line.find('=');
+        if (eq == std::string::npos) return fail("expected key = value");
+        std::string key = trim(line.substr(0, eq));
+        std::string value = trim(line.substr(eq + 1));
+        try {
+            if (section == "phase") {
+                if (!set_phase_option(spec.phased.phases.back(), key, value, error)) return fail(error);
+            }
+            else if (section == "case") {
+                SpecCase& c = spec.cases.back();
+                char slash = 0;
+                std::istringstream v(value);
+                if (key == "generator") {
+                    if (value != "var6" && value != "uniform" && value != "skewed" && value != "keyed" && value != "file"
+                        && value != "case-a" && value != "case-b" && value != "case-c") {
+                        return fail("unknown generator " + value
+                            + " (expected var6, uniform, skewed, keyed, case-a, case-b, case-c or file)");
+                    }
+                    c.generator = value;
+                }
+                else if (key == "m") {
+                    c.m = std::max<size_t>(1, std::stoul(value));
+                    c.m_line = line_no;
+                }
+                else if (key == "mix") {
+                    if (!(v >> c.keyed.read_pct >> slash >> c.keyed.write_pct) || slash != '/' || c.keyed.read_pct < 0
+                        || c.keyed.write_pct < 0 || c.keyed.read_pct + c.keyed.write_pct > 100) {
+                        return fail("bad mix " + value + " (expected <read%>/<write%>)");
+                    }
+                }
+                else if (key == "dist") {
+                    if (!parse_field_dist(value, c.keyed.dist.kind)) return fail("unknown distribution " + value);
+                }
+                else if (key == "theta") {
+                    c.keyed.dist.theta = std::stod(value);
+                    if (c.keyed.dist.theta < 0 || c.keyed.dist.theta >= 1) return fail("theta must be in [0, 1)");
+                }
+                else if (key == "hot-fraction") c.keyed.dist.hot_fraction = std::clamp(std::stod(value), 0.0, 1.0);
+                else if (key == "hot-ops") c.keyed.dist.hot_ops = std::clamp(std::stod(value), 0.0, 1.0);
+                else if (key == "latest-shift") c.keyed.dist.latest_shift_ops = std::max<size_t>(1, std::stoul(value));
+                else if (key == "prefix") c.prefix = value;
+                else if (key == "separator") c.separator = value;
+                else return fail("unknown case key " + key);
+            }
+            else if (section == "run") {
+                if (key == "seed") {
+                    spec.seed = std::stoull(value);
+                    spec.seed_set = true;
+                }
+                else if (key == "ops") spec.ops = std::max<size_t>(1, std::stoull(value));
+                else if (key == "threads") {
+                    spec.threads.clear();
+                    std::istringstream v(value);
+                    std::string item;
+                    while (std::getline(v, item, ',')) {
+                        if (trim(item).empty()) continue;
+                        spec.threads.push_back(std::stoi(item));
+                        if (spec.threads.back() < 1) return fail("threads must be >= 1");
+                    }
+                    if (spec.threads.empty()) return fail("empty thread list");
+                }
+                else if (key == "trials") {
+                    spec.trials = std::stoi(value);
+                    if (spec.trials < 1) return fail("trials must be >= 1");
+                }
+                else if (key == "warmup-runs") {
+                    spec.warmup_runs = std::stoi(value);
+                    if (spec.warmup_runs < 0) return fail("warmup-runs must be >= 0");
+                }
+                else if (key == "latency") spec.record_latency = value == "true" || value == "1" || value == "yes";
+                else if (key == "backends") {
+                    spec.backends.clear();
+                    std::istringstream v(value);
+                    std::string item;
+                    while (std::getline(v, item, ',')) {
+                        if (!trim(item).empty()) spec.backends.push_back(trim(item));
+                    }
+                }
+                else if (key == "csv") spec.csv_path = value;
+                else if (key == "json") spec.json_path = value;
+                else if (key == "phase-m") spec.phased.m = std::max<size_t>(1, std::stoul(value));
+                else return fail("unknown run key " + key);
+            }
+            else {
+                return fail("key outside of a section");
+            }
+        }
+        catch (const std::exception&) {
+            return fail("bad value for " + key + ": " + value);
+        }
+    }
+    if (!finish_phase()) return false;
+    if (spec.cases.empty() && spec.phased.phases.empty()) {
+        std::cerr << path << ": no [case] or [phase] sections\n";
+        return false;
+    }
+    for (const auto& c : spec.cases) {
+        if (c.generator == "file" && c.prefix.empty()) {
+            std::cerr << path << ": case " << c.name << " reads traces from files and needs prefix =\n";
+            return false;
+        }
+        if ((c.generator == "var6" || c.generator == "skewed") && c.m != 3) {
+            return fail_at(c.m_line, "generator " + c.generator + " always uses 3 fields (got m = "
+                + std::to_string(c.m) + ")");
+        }
+    }
+    return true;
+}
+
+// Runs every case x backend x thread count of the spec with warmup runs and
+// repeated trials, then the phases if there are any.
+int run_spec(BenchOptions& opts) {
+    WorkloadSpec spec;
+    if (!load_spec(opts.spec_path, spec)) return 1;
+    uint64_t seed = spec.seed_set ? spec.seed : opts.gen.seed;
+    int max_threads = *std::max_element(spec.threads.begin(), spec.threads.end());
+
+    std::vector<Backend> known = all_backends();
+    std::vector<Backend> backends = spec.backends.empty() ? known : std::vector<Backend>();
+    for (const auto& name : spec.backends) {
+        auto it = std::find_if(known.begin(), known.end(), [&](const Backend& b) { return name == b.name; });
+        if (it == known.end()) {
+            std::cerr << "Unknown backend in spec: " << name << "\n";
+            return 1;
+        }
+        backends.push_back(*it);
+    }
+
+    if (opts.trace_source == TraceSource::Lazy) std::cout << "Lazy traces do not apply to specs; building them in memory\n";
+    trace_catalog.source = opts.trace_source == TraceSource::File ? TraceSource::File : TraceSource::Memory;
+    trace_catalog.threads = opts.gen.threads;
+    trace_catalog.chunk_ops = opts.gen.chunk_ops;
+    std::vector<std::string> prefixes;
+    for (const auto& c : spec.cases) {
+        if (c.generator == "file") {
+            prefixes.push_back(c.prefix);
+            continue;
+        }
+        TraceGenerator gen = c.generator == "var6" ? variant6_trace(spec.ops, seed)
+            : c.generator == "skewed" ? skewed_trace(spec.ops, seed)
+            : c.generator == "keyed" ? keyed_trace(spec.ops, [&c] { KeyedTraceConfig k = c.keyed; k.m = c.m; return k; }(), seed)
+            : c.generator.rfind("case-", 0) == 0 ? demo_traces(spec.ops, c.m, seed)[c.generator[5] - 'a']
+            : uniform_trace(spec.ops, static_cast<int>(c.m), seed);
+        gen.prefix = "spec_" + c.name;
+        std::replace(gen.prefix.begin(), gen.prefix.end(), ' ', '_');
+        prefixes.push_back(gen.prefix);
+        if (opts.trace_source == TraceSource::File || opts.export_traces) {
+            if (!write_trace_files(gen, max_threads, opts.gen)) return 1;
+        }
+        trace_catalog.generators.push_back(std::move(gen));
+    }
+
+    std::cout << "Spec " << opts.spec_path << ": " << spec.cases.size() << " cases, " << backends.size() << " backends, "
+        << spec.threads.size() << " thread counts, " << spec.trials << " trials (+" << spec.warmup_runs
+        << " warmup), seed " << seed << "\n\n";
+
+    WorkerPool pool(max_threads);
+    apply_placement(pool, opts.placement);
+    ResultSink sink;
+
+    for (size_t ci = 0; ci < spec.cases.size(); ++ci) {
+        const SpecCase& c = spec.cases[ci];
+        std::vector<std::vector<Op>> traces = load_traces(prefixes[ci], max_threads, c.separator);
+        if (std::any_of(traces.begin(), traces.end(), [](const std::vector<Op>& t) { return t.empty(); })) {
+            std::cout << "Skipping " << c.name << ": missing traces\n\n";
+            continue;
+        }
+        std::cout << "Case: " << c.name << " (" << c.generator << ", m=" << c.m << ")\n";
+        std::cout << "    " << std::left << std::setw(14) << "backend" << std::right << std::setw(8) << "threads"
+            << std::setw(12) << "Mops/s" << std::setw(10) << "ci95 %";
+        if (spec.record_latency) std::cout << std::setw(10) << "p50 ns" << std::setw(10) << "p99 ns";
+        std::cout << "\n";
+        for (const auto& b : backends) {
+            for (int t : spec.threads) {
+                std::vector<std::vector<Op>> thread_ops(traces.begin(), traces.begin() + t);
+                for (int w = 0; w < spec.warmup_runs; ++w) b.run(thread_ops, c.m, pool, false);
+                std::vector<double> seconds;
+                RunResult last;
+                for (int k = 0; k < spec.trials; ++k) {
+                    last = b.run(thread_ops, c.m, pool, false).result;
+                    seconds.push_back(last.seconds);
+                }
+                TrialStats st = summarize_trials(seconds);
+                if (spec.record_latency) last.latency = b.run(thread_ops, c.m, pool, true).result.latency;
+                last.seconds = st.median;
+
+                std::cout << "    " << std::left << std::setw(14) << b.name << std::right << std::setw(8) << t
+                    << std::fixed << std::setprecision(2) << std::setw(12)
+                    << (st.median > 0 ? last.ops / st.median / 1e6 : 0) << std::setprecision(1) << std::setw(10)
+                    << (st.mean > 0 ? 100.0 * st.ci95 / st.mean : 0) << std::defaultfloat << std::setprecision(6);
+                if (spec.record_latency) {
+                    LatencyHistogram all;
+                    for (const auto& h : last.latency.by_type) all.merge(h);
+                    std::cout << std::setw(10) << all.percentile(0.5) << std::setw(10) << all.percentile(0.99);
+                }
+                std::cout << "\n";
+
+                ResultRecord rec = make_record("spec", c.name, Executor::Locking, pool, t, c.m, last);
+                rec.backend = b.name;
+                rec.has_trials = true;
+                rec.trials = st.n;
+                rec.mean = st.mean;
+                rec.median = st.median;
+                rec.stddev = st.stddev;
+                rec.ci95 = st.ci95;
+                sink.add(rec);
+            }
+        }
+        std::cout << "\n";
+    }
+
+    if (!spec.phased.phases.empty()) {
+        auto traces = build_phase_traces(spec.phased, max_threads, seed, opts.gen.threads);
+        for (const auto& b : backends) {
+            std::vector<RunResult> results = b.phased(spec.phased, traces, max_threads, pool, spec.record_latency);
+            print_phases(spec.phased, b.name, max_threads, results, spec.record_latency);
+            for (size_t p = 0; p < results.size(); ++p) {
+                ResultRecord rec = make_record("phased", spec.phased.phases[p].name, Executor::Locking, pool,
+                    max_threads, spec.phased.m, results[p]);
+                rec.backend = b.name;
+                sink.add(rec);
+            }
+        }
+    }
+
+    std::string csv_path = opts.csv_path.empty() ? spec.csv_path : opts.csv_path;
+    std::string json_path = opts.json_path.empty() ? spec.json_path : opts.json_path;
+    if (!csv_path.empty() && sink.write_csv(csv_path)) std::cout << "Results written to " << csv_path << "\n";
+    if (!json_path.empty() && sink.write_json(json_path)) std::cout << "Results written to " << json_path << "\n";
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    BenchOptions opts;
+    opts.gen.threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    if (!parse_options(argc, argv, opts)) return 1;
+    if (!opts.seed_set) opts.gen.seed = (uint64_t{ std::random_device{}() } << 32) | std::random_device{}();
+    if (!opts.spec_path.empty()) return run_spec(opts);
+
+    const int M = 3; 
+    const size_t DEMO_M = 16;
+    const size_t OPS_PER_THREAD = opts.trace_ops;
+    const int MAX_THREADS = 3;
+
+    int cores = opts.scaling_cores > 0 ? opts.scaling_cores
+        : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    std::vector<int> points = scaling_points(cores, opts.oversubscription);
+    int trace_threads = opts.scaling ? points.back() : MAX_THREADS;
+
+    struct BenchCase {
+        std::string name;
+        std::string prefix;
+        size_t m;
+    };
+    std::vector<BenchCase> cases = { { "Variant 6", "var6", M }, { "Uniform", "uniform", M }, { "Skewed", "skewed", M } };
+    std::vector<BenchCase> demo_cases = { { "Case (a)", "case_a", DEMO_M }, { "Case (b)", "case_b", DEMO_M },
+        { "Case (c)", "case_c", DEMO_M } };
+    if (opts.demo) cases = demo_cases;
+    trace_catalog.source = opts.trace_source;
+    trace_catalog.threads = opts.gen.threads;
+    trace_catalog.chunk_ops = opts.gen.chunk_ops;
+    trace_catalog.generators = { variant6_trace(OPS_PER_THREAD, opts.gen.seed), uniform_trace(OPS_PER_THREAD, M, opts.gen.seed),
+        skewed_trace(OPS_PER_THREAD, opts.gen.seed) };
+    for (auto& g : demo_traces(OPS_PER_THREAD, DEMO_M, opts.gen.seed)) trace_catalog.generators.push_back(std::move(g));
+    if (opts.keyed) {
+        if (opts.thetas.empty()) opts.thetas.push_back(opts.keyed_cfg.dist.theta);
+        for (double theta : opts.thetas) {
+            KeyedTraceConfig kc = opts.keyed_cfg;
+            kc.dist.theta = theta;
+            trace_catalog.generators.push_back(keyed_trace(OPS_PER_THREAD, kc, opts.gen.seed));
+            cases.push_back({ keyed_case_name(kc), keyed_prefix(kc), kc.m });
+            bool uses_theta = kc.dist.kind == FieldDist::Zipf || kc.dist.kind == FieldDist::ScrambledZipf
+                || kc.dist.kind == FieldDist::Latest;
+            if (!uses_theta) break;
+        }
+    }
+
+    std::cout << "Traces: " << trace_source_name(opts.trace_source) << " (seed " << opts.gen.seed << ", "
+        << opts.gen.threads << " generator threads)\n";
+    if (opts.trace_source == TraceSource::File || opts.export_traces) {
+        std::cout << "Generating Files\n";
+        for (const auto& g : trace_catalog.generators) {
+            if (!write_trace_files(g, trace_threads, opts.gen)) return 1;
+        }
+        std::cout << "Files generated.\n";
+    }
+    if (opts.trace_source == TraceSource::Lazy) {
+        bool other_mode = opts.compare || opts.check_history || !opts.backends.empty() || opts.scaling || opts.open_loop
+            || opts.phased || opts.capture_overhead || opts.exec.duration_s > 0 || opts.exec.trials > 1
+            || opts.exec.warmup_runs > 0;
+        bool other_executor = std::any_of(opts.executors.begin(), opts.executors.end(),
+            [](Executor e) { return e != Executor::Locking; });
+        if (other_mode) {
+            std::cout << "Lazy traces apply to single closed-loop runs; this mode builds them in memory\n";
+        }
+        else if (other_executor || opts.exec.lock_stats || opts.exec.perf_counters) {
+            std::cout << "Lazy traces apply to the locking executor without --lock-stats or --perf; "
+                << "the other runs build them in memory\n";
+        }
+    }
+    std::cout << "\n";
+
+    std::cout << "Starting Measurements\n";
+
+    WorkerPool pool(trace_threads);
+    apply_placement(pool, opts.placement);
+
+    ResultSink sink;
+
+    std::vector<Backend> known = all_backends();
+    std::vector<Backend> backends = opts.backends.empty() ? known : std::vector<Backend>();
+    for (const auto& name : opts.backends) {
+        auto it = std::find_if(known.begin(), known.end(), [&](const Backend& b) { return name == b.name; });
+        if (it == known.end()) {
+            std::cerr << "Unknown backend: " << name << " (known: shared_mutex, mutex, global-lock, seqlock, atomic)\n";
+            return 1;
+        }
+        backends.push_back(*it);
+    }
+
+    if (opts.capture_overhead) {
+        measure_capture_overhead(cases[0].name, cases[0].prefix, MAX_THREADS, cases[0].m, pool,
+            opts.exec.trials > 1 ? opts.exec.trials : 7);
+    }
+    else if (opts.phased) {
+        if (opts.phased_cfg.phases.empty()) opts.phased_cfg.phases = default_phases(opts.phased_cfg.m);
+        if (opts.backends.empty()) backends = { known[0] };
+        auto traces = build_phase_traces(opts.phased_cfg, MAX_THREADS, opts.gen.seed, opts.gen.threads);
+        for (const auto& b : backends) {
+            std::vector<RunResult> results = b.phased(opts.phased_cfg, traces, MAX_THREADS, pool, opts.exec.record_latency);
+            print_phases(opts.phased_cfg, b.name, MAX_THREADS, results, opts.exec.record_latency);
+            for (size_t p = 0; p < results.size(); ++p) {
+                ResultRecord rec = make_record("phased", opts.phased_cfg.phases[p].name, Executor::Locking, pool,
+                    MAX_THREADS, opts.phased_cfg.m, results[p]);
+                rec.backend = b.name;
+                sink.add(rec);
+            }
+        }
+    }
+    else if (opts.compare || opts.check_history || !opts.backends.empty()) {
+        std::vector<Workload> workloads;
+        for (const auto& c : cases) workloads.push_back({ c.name, c.prefix, "_t", c.m });
+        if (!opts.demo) {
+            for (const auto& c : demo_cases) workloads.push_back({ c.name, c.prefix, "_t", c.m });
+        }
+        if (opts.check_history) {
+            return check_backends(workloads, backends, MAX_THREADS, pool) ? 0 : 1;
+        }
+        for (const auto& c : compare_backends(workloads, backends, MAX_THREADS, pool)) {
+            ResultRecord rec = make_record("compare", c.workload, Executor::Locking, pool, c.threads, c.m, c.result);
+            rec.backend = c.backend;
+            sink.add(rec);
+        }
+    }
+    else if (opts.scaling) {
+        for (const auto& c : cases) {
+            for (Executor executor : opts.executors) {
+                for (const auto& pt : run_scaling(c.name, c.prefix, points, cores, c.m, pool, executor, opts.exec)) {
+                    sink.add(make_record("scaling", c.name, executor, pool, pt.threads, c.m, pt.result));
+                }
+            }
+        }
+    }
+    else if (opts.open_loop) {
+        for (const auto& c : cases) {
+            for (const auto& r : sweep_open_loop(c.name, c.prefix, MAX_THREADS, c.m, pool, opts.open_loop_cfg)) {
+                ResultRecord rec;
+                rec.mode = "open-loop";
+                rec.case_name = c.name;
+                rec.executor = executor_name(Executor::Locking);
+                rec.placement = pool.placement();
+                rec.threads = MAX_THREADS;
+                rec.m = c.m;
+                rec.ops = r.ops;
+                rec.seconds = r.achieved_rate > 0 ? r.ops / r.achieved_rate : 0;
+                rec.throughput = r.achieved_rate;
+                rec.has_rate = true;
+                rec.target_rate = r.target_rate;
+                for (int t = 0; t < 3; ++t) rec.op_counts[t] = r.latency.by_type[t].count();
+                fill_latency(rec, r.latency);
+                sink.add(rec);
+            }
+        }
+    }
+    else if (opts.exec.duration_s > 0) {
+        if (opts.executors != std::vector<Executor>{ Executor::Locking }) {
+            std::cout << "Duration mode runs the locking executor only\n";
+        }
+        for (size_t ci = 0; ci < cases.size(); ++ci) {
+            if (ci > 0) std::cout << "\n";
+            for (int t = 1; t <= MAX_THREADS; ++t) {
+                MultiField data(cases[ci].m);
+                RunResult r = run_timed(cases[ci].name, cases[ci].prefix, t, data, pool, opts.exec);
+                sink.add(make_record("timed", cases[ci].name, Executor::Locking, pool, t, cases[ci].m, r));
+            }
+        }
+    }
+    else {
+        for (size_t ci = 0; ci < cases.size(); ++ci) {
+            if (ci > 0) std::cout << "\n";
+            for (Executor executor : opts.executors) {
+                for (int t = 1; t <= MAX_THREADS; ++t) {
+                    if (opts.exec.trials > 1 || opts.exec.warmup_runs > 0) {
+                        TrialStats st = run_trials(cases[ci].name, cases[ci].prefix, t, cases[ci].m, pool, executor, opts.exec);
+                        RunResult summary;
+                        summary.ops = st.ops;
+                        summary.seconds = st.median;
+                        std::copy(std::begin(st.op_counts), std::end(st.op_counts), summary.op_counts);
+                        summary.latency = st.latency;
+                        ResultRecord rec = make_record("trials", cases[ci].name, executor, pool, t, cases[ci].m, summary);
+                        rec.has_trials = true;
+                        rec.trials = st.n;
+                        rec.mean = st.mean;
+                        rec.median = st.median;
+                        rec.stddev = st.stddev;
+                        rec.ci95 = st.ci95;
+                        sink.add(rec);
+                        continue;
+                    }
+                    MultiField data(cases[ci].m);
+                    RunResult r = run_test(cases[ci].name, cases[ci].prefix, t, data, pool, executor, opts.exec);
+                    sink.add(make_record("closed-loop", cases[ci].name, executor, pool, t, cases[ci].m, r));
+                }
+            }
+        }
+    }
+
+    if (!opts.csv_path.empty() && sink.write_csv(opts.csv_path)) std::cout << "Results written to " << opts.csv_path << "\n";
+    if (!opts.json_path.empty() && sink.write_json(opts.json_path)) std::cout << "Results written to " << opts.json_path << "\n";
+
+    return 0;
 }
\ No newline at end of file
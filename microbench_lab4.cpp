@@ -0,0 +1,247 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <iomanip>
+#include <random>
+
+#include "multi_field.h"
+#include "alias_table.h"
+
+template <typename T>
+inline void do_not_optimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+inline void clobber_memory() {
+    asm volatile("" : : : "memory");
+}
+
+enum class Primitive { Read, Write, ToString };
+
+// hot: every thread uses field 0; spread: thread t uses field t % m.
+enum class Pattern { Hot, Spread };
+
+const char* primitive_name(Primitive p) {
+    switch (p) {
+    case Primitive::Read: return "read";
+    case Primitive::Write: return "write";
+    case Primitive::ToString: return "to_string";
+    }
+    return "unknown";
+}
+
+const char* pattern_name(Pattern p) {
+    return p == Pattern::Hot ? "hot" : "spread";
+}
+
+struct MicroConfig {
+    size_t fixed_iters = 0;
+    double min_time_s = 0.2;
+    std::vector<size_t> ms = { 3, 16, 256 };
+    std::vector<int> threads;
+    std::vector<size_t> sampler_ms = { 8, 1024, 1 << 20 };
+};
+
+void run_primitive(MultiField& mf, Primitive prim, size_t idx, size_t iters) {
+    switch (prim) {
+    case Primitive::Read:
+        for (size_t i = 0; i < iters; ++i) {
+            int v = mf.read(idx);
+            do_not_optimize(v);
+        }
+        break;
+    case Primitive::Write:
+        for (size_t i = 0; i < iters; ++i) {
+            mf.write(idx, static_cast<int>(i));
+            clobber_memory();
+        }
+        break;
+    case Primitive::ToString:
+        for (size_t i = 0; i < iters; ++i) {
+            std::string s = mf.to_string();
+            do_not_optimize(s);
+        }
+        break;
+    }
+}
+
+// Runs `iters` calls on each of `threads` threads, all released together, and
+// returns the slowest thread's time. Thread creation happens before the start.
+double run_batch(MultiField& mf, Primitive prim, Pattern pattern, int threads, size_t iters) {
+    std::atomic<int> ready{ 0 };
+    std::atomic<bool> go{ false };
+    std::vector<double> seconds(threads);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            size_t idx = pattern == Pattern::Hot ? 0 : t % mf.size();
+            ready.fetch_add(1);
+            while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+            auto t0 = std::chrono::steady_clock::now();
+            run_primitive(mf, prim, idx, iters);
+            auto t1 = std::chrono::steady_clock::now();
+            seconds[t] = std::chrono::duration<double>(t1 - t0).count();
+            });
+    }
+    while (ready.load() < threads) std::this_thread::yield();
+    go.store(true, std::memory_order_release);
+    for (auto& w : workers) w.join();
+    return *std::max_element(seconds.begin(), seconds.end());
+}
+
+// With --iters the iteration count is fixed; otherwise it grows until one
+// batch runs for at least --min-time, like the auto-scaling timers of the
+// usual benchmark libraries.
+void measure(Primitive prim, Pattern pattern, size_t m, int threads, const MicroConfig& cfg) {
+    MultiField mf(m);
+    size_t iters = cfg.fixed_iters > 0 ? cfg.fixed_iters : 1;
+    double secs = 0;
+    while (true) {
+        secs = run_batch(mf, prim, pattern, threads, iters);
+        if (cfg.fixed_iters > 0 || secs >= cfg.min_time_s) break;
+        double grow = secs > 0 ? 1.4 * cfg.min_time_s / secs : 10.0;
+        iters = static_cast<size_t>(iters * std::clamp(grow, 2.0, 10.0));
+    }
+    double ns_per_op = secs * 1e9 / iters;
+    double total_mops = threads * iters / secs / 1e6;
+    std::cout << std::left << std::setw(10) << primitive_name(prim) << std::setw(8) << pattern_name(pattern)
+        << std::right << std::setw(7) << m << std::setw(9) << threads << std::setw(12) << iters
+        << std::fixed << std::setprecision(1) << std::setw(12) << ns_per_op
+        << std::setprecision(2) << std::setw(14) << total_mops
+        << std::defaultfloat << std::setprecision(6) << "\n";
+}
+
+// Times `iters` draws from `sample` with the same auto-scaling as measure().
+template <typename Sample>
+double time_sampler(Sample&& sample, const MicroConfig& cfg, size_t& iters) {
+    iters = cfg.fixed_iters > 0 ? cfg.fixed_iters : 1;
+    while (true) {
+        auto t0 = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < iters; ++i) {
+            size_t v = sample();
+            do_not_optimize(v);
+        }
+        double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        if (cfg.fixed_iters > 0 || secs >= cfg.min_time_s) return secs;
+        double grow = secs > 0 ? 1.4 * cfg.min_time_s / secs : 10.0;
+        iters = static_cast<size_t>(iters * std::clamp(grow, 2.0, 10.0));
+    }
+}
+
+// std::discrete_distribution against AliasTable over Zipf-like weights
+// 1/(i+1), both fed by the same mt19937_64 so only the sampling cost differs.
+void measure_samplers(size_t m, const MicroConfig& cfg) {
+    std::vector<double> weights(m);
+    for (size_t i = 0; i < m; ++i) weights[i] = 1.0 / (i + 1);
+
+    auto b0 = std::chrono::steady_clock::now();
+    std::discrete_distribution<size_t> dist(weights.begin(), weights.end());
+    auto b1 = std::chrono::steady_clock::now();
+    AliasTable table(weights);
+    auto b2 = std::chrono::steady_clock::now();
+
+    std::mt19937_64 rng(42);
+    size_t iters = 0;
+    double secs = time_sampler([&] { return dist(rng); }, cfg, iters);
+    std::cout << std::left << std::setw(24) << "discrete_distribution" << std::right << std::setw(10) << m
+        << std::fixed << std::setprecision(2) << std::setw(12) << std::chrono::duration<double, std::milli>(b1 - b0).count()
+        << std::setw(12) << iters << std::setprecision(1) << std::setw(12) << secs * 1e9 / iters
+        << std::defaultfloat << std::setprecision(6) << "\n";
+
+    secs = time_sampler([&] { return table.sample(rng()); }, cfg, iters);
+    std::cout << std::left << std::setw(24) << "alias" << std::right << std::setw(10) << m
+        << std::fixed << std::setprecision(2) << std::setw(12) << std::chrono::duration<double, std::milli>(b2 - b1).count()
+        << std::setw(12) << iters << std::setprecision(1) << std::setw(12) << secs * 1e9 / iters
+        << std::defaultfloat << std::setprecision(6) << "\n";
+}
+
+// Every entry must be a positive integer: a zero thread count or field
+// count has nothing to run.
+template <typename T>
+bool parse_list(const std::string& text, std::vector<T>& out) {
+    out.clear();
+    std::istringstream iss(text);
+    std::string item;
+    while (std::getline(iss, item, ',')) {
+        if (item.empty()) continue;
+        if (item.find_first_not_of("0123456789") != std::string::npos) return false;
+        unsigned long value = std::stoul(item);
+        if (value == 0) return false;
+        out.push_back(static_cast<T>(value));
+    }
+    return !out.empty();
+}
+
+int main(int argc, char** argv) {
+    MicroConfig cfg;
+    int hw = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    cfg.threads = { 1, 2, hw };
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.rfind("--iters=", 0) == 0) {
+            std::string value = arg.substr(8);
+            if (value.empty() || value.size() > 18 || value.find_first_not_of("0123456789") != std::string::npos) {
+                std::cerr << "Bad iteration count: " << value << " (expected an integer >= 0, 0 for auto)\n";
+                return 1;
+            }
+            cfg.fixed_iters = std::stoull(value);
+        }
+        else if (arg.rfind("--min-time=", 0) == 0) {
+            std::string value = arg.substr(11);
+            std::istringstream iss(value);
+            if (!(iss >> cfg.min_time_s) || !iss.eof() || !(cfg.min_time_s >= 0)) {
+                std::cerr << "Bad min time: " << value << " (expected seconds >= 0)\n";
+                return 1;
+            }
+        }
+        else if (arg.rfind("--m=", 0) == 0) {
+            if (!parse_list(arg.substr(4), cfg.ms)) {
+                std::cerr << "Bad field count list: " << arg.substr(4) << "\n";
+                return 1;
+            }
+        }
+        else if (arg.rfind("--sampler-m=", 0) == 0) {
+            if (!parse_list(arg.substr(12), cfg.sampler_ms)) {
+                std::cerr << "Bad sampler size list: " << arg.substr(12) << "\n";
+                return 1;
+            }
+        }
+        else if (arg.rfind("--threads=", 0) == 0) {
+            if (!parse_list(arg.substr(10), cfg.threads)) {
+                std::cerr << "Bad thread list: " << arg.substr(10) << "\n";
+                return 1;
+            }
+        }
+        else {
+            std::cerr << "Unknown option: " << arg << "\n";
+            return 1;
+        }
+    }
+    std::sort(cfg.threads.begin(), cfg.threads.end());
+    cfg.threads.erase(std::unique(cfg.threads.begin(), cfg.threads.end()), cfg.threads.end());
+
+    std::cout << std::left << std::setw(10) << "primitive" << std::setw(8) << "pattern"
+        << std::right << std::setw(7) << "m" << std::setw(9) << "threads" << std::setw(12) << "iters"
+        << std::setw(12) << "ns/op" << std::setw(14) << "total Mops/s" << "\n";
+
+    const Primitive prims[] = { Primitive::Read, Primitive::Write, Primitive::ToString };
+    for (Primitive prim : prims) {
+        for (size_t m : cfg.ms) {
+            for (int threads : cfg.threads) {
+                measure(prim, Pattern::Hot, m, threads, cfg);
+                if (threads > 1 && prim != Primitive::ToString) measure(prim, Pattern::Spread, m, threads, cfg);
+            }
+        }
+    }
+
+    std::cout << "\n" << std::left << std::setw(24) << "sampler" << std::right << std::setw(10) << "m"
+        << std::setw(12) << "build ms" << std::setw(12) << "iters" << std::setw(12) << "ns/sample" << "\n";
+    for (size_t m : cfg.sampler_ms) measure_samplers(m, cfg);
+    return 0;
+}
@@ -0,0 +1,341 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <sstream>
+#include <chrono>
+#include <shared_mutex>
+#include <mutex>
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <charconv>
+
+enum class OpType { READ, WRITE, STRING };
+
+struct Op {
+    OpType type;
+    int idx;   
+    int value; 
+};
+
+inline std::string fields_to_string(const std::vector<int>& vals) {
+    std::ostringstream oss;
+    oss << "{";
+    for (size_t i = 0; i < vals.size(); ++i) {
+        if (i > 0) oss << ", ";
+        oss << vals[i];
+    }
+    oss << "}";
+    return oss.str();
+}
+
+inline void append_int(std::string& out, int value) {
+    char buf[16];
+    auto res = std::to_chars(buf, buf + sizeof(buf), value);
+    out.append(buf, res.ptr);
+}
+
+// Appends op as one line of the text trace format load_ops reads.
+inline void append_op(std::string& out, const Op& op) {
+    switch (op.type) {
+    case OpType::READ:
+        out += "read ";
+        append_int(out, op.idx);
+        break;
+    case OpType::WRITE:
+        out += "write ";
+        append_int(out, op.idx);
+        out += ' ';
+        append_int(out, op.value);
+        break;
+    case OpType::STRING:
+        out += "string";
+        break;
+    }
+    out += '\n';
+}
+
+struct FieldLockStats {
+    uint64_t acquisitions = 0;
+    uint64_t contended = 0;
+    uint64_t wait_ns = 0;
+    uint64_t hold_ns = 0;
+};
+
+struct LockProfile {
+    std::vector<FieldLockStats> fields;
+
+    void merge(const LockProfile& other) {
+        if (fields.size() < other.fields.size()) fields.resize(other.fields.size());
+        for (size_t i = 0; i < other.fields.size(); ++i) {
+            fields[i].acquisitions += other.fields[i].acquisitions;
+            fields[i].contended += other.fields[i].contended;
+            fields[i].wait_ns += other.fields[i].wait_ns;
+            fields[i].hold_ns += other.fields[i].hold_ns;
+        }
+    }
+};
+
+// Set by a worker thread for the duration of a run to turn on lock profiling
+// in MultiField; each thread owns its profile, so counting needs no atomics.
+inline thread_local LockProfile* lock_profile = nullptr;
+
+class MultiField {
+public:
+    explicit MultiField(size_t m) : vals(m, 0), locks(m) {}
+
+    int read(size_t idx) const {
+        if (idx >= vals.size()) return 0;
+        if (lock_profile) return profiled_read(idx);
+        std::shared_lock<std::shared_mutex> lk(locks[idx]);
+        return vals[idx];
+    }
+
+    void write(size_t idx, int value) {
+        if (idx >= vals.size()) return;
+        if (lock_profile) return profiled_write(idx, value);
+        std::unique_lock<std::shared_mutex> lk(locks[idx]);
+        vals[idx] = value;
+    }
+
+    std::string to_string() const {
+        if (lock_profile) return profiled_to_string();
+        std::vector<std::shared_lock<std::shared_mutex>> acquired_locks;
+        acquired_locks.reserve(locks.size());
+        for (auto& mtx : locks) {
+            acquired_locks.emplace_back(mtx);
+        }
+
+        return fields_to_string(vals);
+    }
+
+    operator std::string() const {
+        return to_string();
+    }
+
+    size_t size() const { return vals.size(); }
+
+private:
+    static uint64_t now_ns() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    template <typename Lock>
+    static uint64_t acquire(Lock& lk, FieldLockStats& st) {
+        uint64_t t0 = now_ns();
+        if (!lk.try_lock()) {
+            ++st.contended;
+            lk.lock();
+        }
+        uint64_t t1 = now_ns();
+        ++st.acquisitions;
+        st.wait_ns += t1 - t0;
+        return t1;
+    }
+
+    int profiled_read(size_t idx) const {
+        FieldLockStats& st = lock_profile->fields[idx];
+        std::shared_lock<std::shared_mutex> lk(locks[idx], std::defer_lock);
+        uint64_t held = acquire(lk, st);
+        int value = vals[idx];
+        lk.unlock();
+        st.hold_ns += now_ns() - held;
+        return value;
+    }
+
+    void profiled_write(size_t idx, int value) {
+        FieldLockStats& st = lock_profile->fields[idx];
+        std::unique_lock<std::shared_mutex> lk(locks[idx], std::defer_lock);
+        uint64_t held = acquire(lk, st);
+        vals[idx] = value;
+        lk.unlock();
+        st.hold_ns += now_ns() - held;
+    }
+
+    std::string profiled_to_string() const {
+        std::vector<std::shared_lock<std::shared_mutex>> acquired_locks;
+        std::vector<uint64_t> held(locks.size());
+        acquired_locks.reserve(locks.size());
+        for (size_t i = 0; i < locks.size(); ++i) {
+            acquired_locks.emplace_back(locks[i], std::defer_lock);
+            held[i] = acquire(acquired_locks.back(), lock_profile->fields[i]);
+        }
+        std::string s = fields_to_string(vals);
+        for (auto& lk : acquired_locks) lk.unlock();
+        uint64_t released = now_ns();
+        for (size_t i = 0; i < locks.size(); ++i) {
+            lock_profile->fields[i].hold_ns += released - held[i];
+        }
+        return s;
+    }
+
+    std::vector<int> vals;
+    mutable std::vector<std::shared_mutex> locks;
+};
+
+// Alternative MultiField backends. They all expose the same read / write /
+// to_string / size shape as MultiField, so the benchmark code is written once
+// as templates over the field type instead of going through virtual calls.
+
+class MutexMultiField {
+public:
+    explicit MutexMultiField(size_t m) : vals(m, 0), locks(m) {}
+
+    int read(size_t idx) const {
+        if (idx >= vals.size()) return 0;
+        std::lock_guard<std::mutex> lk(locks[idx]);
+        return vals[idx];
+    }
+
+    void write(size_t idx, int value) {
+        if (idx >= vals.size()) return;
+        std::lock_guard<std::mutex> lk(locks[idx]);
+        vals[idx] = value;
+    }
+
+    std::string to_string() const {
+        std::vector<std::unique_lock<std::mutex>> acquired_locks;
+        acquired_locks.reserve(locks.size());
+        for (auto& mtx : locks) {
+            acquired_locks.emplace_back(mtx);
+        }
+        return fields_to_string(vals);
+    }
+
+    size_t size() const { return vals.size(); }
+
+private:
+    std::vector<int> vals;
+    mutable std::vector<std::mutex> locks;
+};
+
+class GlobalLockMultiField {
+public:
+    explicit GlobalLockMultiField(size_t m) : vals(m, 0) {}
+
+    int read(size_t idx) const {
+        if (idx >= vals.size()) return 0;
+        std::shared_lock<std::shared_mutex> lk(lock);
+        return vals[idx];
+    }
+
+    void write(size_t idx, int value) {
+        if (idx >= vals.size()) return;
+        std::unique_lock<std::shared_mutex> lk(lock);
+        vals[idx] = value;
+    }
+
+    std::string to_string() const {
+        std::shared_lock<std::shared_mutex> lk(lock);
+        return fields_to_string(vals);
+    }
+
+    size_t size() const { return vals.size(); }
+
+private:
+    std::vector<int> vals;
+    mutable std::shared_mutex lock;
+};
+
+// Per-field sequence locks. Writers make the sequence odd with a CAS, which
+// doubles as the writer lock; readers never write shared memory and retry if
+// the sequence moved. to_string is a double collect over all sequences, so it
+// still returns one consistent snapshot.
+// The value is a relaxed atomic, so the CAS alone does not keep the new value
+// from becoming visible before the odd sequence; a reader could then pair
+// the new value with the old even sequence and accept it. The release fence
+// after the CAS orders the two (Boehm, "Can seqlocks get along with
+// programming language memory models?"). x86 never reorders those stores, so
+// the --check-history runs there cannot show the bug; the fence is for
+// weaker hardware and for the compiler.
+class SeqlockMultiField {
+public:
+    explicit SeqlockMultiField(size_t m) : slots(m) {}
+
+    int read(size_t idx) const {
+        if (idx >= slots.size()) return 0;
+        const Slot& slot = slots[idx];
+        while (true) {
+            uint32_t before = slot.seq.load(std::memory_order_acquire);
+            if (before & 1) continue;
+            int value = slot.value.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.seq.load(std::memory_order_relaxed) == before) return value;
+        }
+    }
+
+    void write(size_t idx, int value) {
+        if (idx >= slots.size()) return;
+        Slot& slot = slots[idx];
+        uint32_t seq = slot.seq.load(std::memory_order_relaxed);
+        while ((seq & 1) || !slot.seq.compare_exchange_weak(seq, seq + 1, std::memory_order_acq_rel)) {
+            seq = slot.seq.load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.value.store(value, std::memory_order_relaxed);
+        slot.seq.store(seq + 2, std::memory_order_release);
+    }
+
+    std::string to_string() const {
+        std::vector<uint32_t> seqs(slots.size());
+        std::vector<int> vals(slots.size());
+        while (true) {
+            bool stable = true;
+            for (size_t i = 0; i < slots.size() && stable; ++i) {
+                seqs[i] = slots[i].seq.load(std::memory_order_acquire);
+                stable = (seqs[i] & 1) == 0;
+            }
+            if (!stable) continue;
+            for (size_t i = 0; i < slots.size(); ++i) {
+                vals[i] = slots[i].value.load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            for (size_t i = 0; i < slots.size() && stable; ++i) {
+                stable = slots[i].seq.load(std::memory_order_relaxed) == seqs[i];
+            }
+            if (stable) return fields_to_string(vals);
+        }
+    }
+
+    size_t size() const { return slots.size(); }
+
+private:
+    struct Slot {
+        std::atomic<uint32_t> seq{ 0 };
+        std::atomic<int> value{ 0 };
+    };
+
+    std::vector<Slot> slots;
+};
+
+// Lock-free per-field atomics. Single-field reads and writes are atomic, but
+// to_string reads the fields one by one and is not a snapshot of all of them.
+class AtomicMultiField {
+public:
+    explicit AtomicMultiField(size_t m) : vals(m) {}
+
+    int read(size_t idx) const {
+        if (idx >= vals.size()) return 0;
+        return vals[idx].load(std::memory_order_acquire);
+    }
+
+    void write(size_t idx, int value) {
+        if (idx >= vals.size()) return;
+        vals[idx].store(value, std::memory_order_release);
+    }
+
+    std::string to_string() const {
+        std::vector<int> snapshot(vals.size());
+        for (size_t i = 0; i < vals.size(); ++i) {
+            snapshot[i] = vals[i].load(std::memory_order_acquire);
+        }
+        return fields_to_string(snapshot);
+    }
+
+    size_t size() const { return vals.size(); }
+
+private:
+    std::vector<std::atomic<int>> vals;
+};
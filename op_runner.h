@@ -0,0 +1,133 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <cstdint>
+
+#include "multi_field.h"
+
+// Log-linear histogram in the spirit of HdrHistogram: values below 64 get
+// exact buckets, above that each power of two is split into 32 sub-buckets,
+// which keeps the relative error around 3% over the whole 64-bit range.
+class LatencyHistogram {
+public:
+    static constexpr int SUB_BITS = 5;
+    static constexpr size_t SUB_COUNT = size_t(1) << SUB_BITS;
+    static constexpr size_t BUCKETS = (64 - SUB_BITS + 1) * SUB_COUNT;
+
+    void record(uint64_t value) {
+        ++counts[bucket_of(value)];
+        ++total;
+        max_value = std::max(max_value, value);
+    }
+
+    void merge(const LatencyHistogram& other) {
+        for (size_t b = 0; b < BUCKETS; ++b) counts[b] += other.counts[b];
+        total += other.total;
+        max_value = std::max(max_value, other.max_value);
+    }
+
+    uint64_t count() const { return total; }
+    uint64_t max() const { return max_value; }
+
+    uint64_t percentile(double q) const {
+        if (total == 0) return 0;
+        uint64_t rank = static_cast<uint64_t>(q * total);
+        if (rank >= total) rank = total - 1;
+        uint64_t seen = 0;
+        for (size_t b = 0; b < BUCKETS; ++b) {
+            seen += counts[b];
+            if (seen > rank) return std::min(bucket_high(b), max_value);
+        }
+        return max_value;
+    }
+
+private:
+    static size_t bucket_of(uint64_t v) {
+        if (v < 2 * SUB_COUNT) return static_cast<size_t>(v);
+        int shift = 63 - __builtin_clzll(v) - SUB_BITS;
+        return (shift + 1) * SUB_COUNT + static_cast<size_t>((v >> shift) - SUB_COUNT);
+    }
+
+    static uint64_t bucket_high(size_t b) {
+        if (b < 2 * SUB_COUNT) return b;
+        int shift = static_cast<int>(b / SUB_COUNT) - 1;
+        uint64_t mantissa = SUB_COUNT + b % SUB_COUNT;
+        return ((mantissa + 1) << shift) - 1;
+    }
+
+    std::vector<uint64_t> counts = std::vector<uint64_t>(BUCKETS, 0);
+    uint64_t total = 0;
+    uint64_t max_value = 0;
+};
+
+struct OpLatency {
+    LatencyHistogram by_type[3];
+
+    void record(OpType type, uint64_t ns) { by_type[static_cast<int>(type)].record(ns); }
+
+    void merge(const OpLatency& other) {
+        for (int t = 0; t < 3; ++t) by_type[t].merge(other.by_type[t]);
+    }
+};
+
+inline void print_latency(const OpLatency& latency) {
+    const char* names[] = { "READ", "WRITE", "STRING" };
+    for (int t = 0; t < 3; ++t) {
+        const auto& h = latency.by_type[t];
+        if (h.count() == 0) continue;
+        std::cout << "    " << std::left << std::setw(7) << names[t] << std::right
+            << "n=" << h.count()
+            << " p50=" << h.percentile(0.5) << "ns"
+            << " p90=" << h.percentile(0.9) << "ns"
+            << " p99=" << h.percentile(0.99) << "ns"
+            << " p99.9=" << h.percentile(0.999) << "ns"
+            << " max=" << h.max() << "ns\n";
+    }
+}
+
+template <typename Apply>
+inline void run_ops(const Op* first, const Op* last, OpLatency* latency, Apply&& apply) {
+    if (!latency) {
+        for (const Op* it = first; it != last; ++it) apply(*it);
+        return;
+    }
+    for (const Op* it = first; it != last; ++it) {
+        auto t0 = std::chrono::steady_clock::now();
+        apply(*it);
+        auto t1 = std::chrono::steady_clock::now();
+        latency->record(it->type, std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count());
+    }
+}
+
+template <typename Field>
+inline void apply_op(Field& data, const Op& op) {
+    switch (op.type) {
+    case OpType::READ:
+        data.read(op.idx);
+        break;
+    case OpType::WRITE:
+        data.write(op.idx, op.value);
+        break;
+    case OpType::STRING: {
+        std::string s = data.to_string();
+        volatile size_t len = s.length();
+        (void)len;
+        break;
+    }
+    }
+}
+
+template <typename Field>
+void worker(Field& data, const Op* first, const Op* last, OpLatency* latency = nullptr) {
+    run_ops(first, last, latency, [&data](const Op& op) { apply_op(data, op); });
+}
+
+template <typename Field>
+void worker(Field& data, const std::vector<Op>& ops, OpLatency* latency = nullptr) {
+    worker(data, ops.data(), ops.data() + ops.size(), latency);
+}
@@ -0,0 +1,298 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <string>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "multi_field.h"
+
+enum class TraceFormat { Text, Binary };
+
+// Cheap timestamp for the recording fast path: the TSC where there is one,
+// steady_clock nanoseconds elsewhere. The flusher converts ticks to ns.
+inline uint64_t trace_ticks() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+// Binary trace: the 8-byte magic, then one 24-byte little-endian record per
+// op: ns since capture start (u64), thread (u32), OpType (u32), idx (i32),
+// value (i32).
+constexpr char BINARY_TRACE_MAGIC[8] = { 'L', '4', 'T', 'R', 'A', 'C', 'E', '1' };
+
+struct TraceRecord {
+    uint64_t ns;
+    uint32_t thread;
+    uint32_t type;
+    int32_t idx;
+    int32_t value;
+};
+
+// Collects the ops of every thread that calls log(). Each thread gets its own
+// single-producer ring on first use, so logging is two plain stores and a
+// release store with no locks or read-modify-writes. A background thread
+// drains the rings and writes either <prefix>_t<thread>.txt files in the
+// load_ops format (timestamps dropped) or one <prefix>.bin with timestamps.
+// A full ring makes its producer wait; those waits are counted as stalls.
+// Reading the clock is the largest part of the cost of log(), so binary
+// captures read it once every `timestamp_every` ops of a thread and stamp the
+// ops in between with that reading; 1 stamps every op exactly. Text captures
+// carry no timestamps and never read it. Threads are numbered in the order
+// they first log. Stop (or destroy) the capture only after every producer is
+// done.
+class TraceCapture {
+public:
+    TraceCapture(std::string prefix, TraceFormat format, size_t ring_records = 1 << 16, uint32_t timestamp_every = 16)
+        : prefix(std::move(prefix)), format(format), id(next_id().fetch_add(1) + 1),
+        timestamp_every(timestamp_every > 0 ? timestamp_every : 1) {
+        capacity = 1;
+        while (capacity < ring_records) capacity <<= 1;
+        start_ticks = trace_ticks();
+        start_time = std::chrono::steady_clock::now();
+        if (format == TraceFormat::Binary) {
+            binary.open(this->prefix + ".bin", std::ios::binary);
+            binary.write(BINARY_TRACE_MAGIC, sizeof(BINARY_TRACE_MAGIC));
+        }
+        flusher = std::thread([this] { flush_loop(); });
+    }
+
+    ~TraceCapture() { stop(); }
+
+    TraceCapture(const TraceCapture&) = delete;
+    TraceCapture& operator=(const TraceCapture&) = delete;
+
+    void log(OpType type, size_t idx, int value) {
+        Ring& ring = ring_for_this_thread();
+        size_t tail = ring.tail.load(std::memory_order_relaxed);
+        if (tail - ring.cached_head == capacity) {
+            ring.cached_head = ring.head.load(std::memory_order_acquire);
+            while (tail - ring.cached_head == capacity) {
+                ++ring.stalls;
+                std::this_thread::yield();
+                ring.cached_head = ring.head.load(std::memory_order_acquire);
+            }
+        }
+        if (format == TraceFormat::Binary && ring.until_timestamp-- == 0) {
+            ring.last_ticks = trace_ticks();
+            ring.until_timestamp = timestamp_every - 1;
+        }
+        Slot& slot = ring.slots[tail & (capacity - 1)];
+        slot.ticks = ring.last_ticks;
+        slot.type = type;
+        slot.idx = static_cast<int32_t>(idx);
+        slot.value = value;
+        ring.tail.store(tail + 1, std::memory_order_release);
+    }
+
+    void stop() {
+        if (!flusher.joinable()) return;
+        stopping.store(true, std::memory_order_release);
+        flusher.join();
+        binary.close();
+        for (auto& r : rings) r->text.close();
+    }
+
+    size_t records() const { return written; }
+
+    size_t stalls() const {
+        std::lock_guard<std::mutex> lk(rings_mutex);
+        size_t total = 0;
+        for (const auto& r : rings) total += r->stalls;
+        return total;
+    }
+
+    size_t threads() const {
+        std::lock_guard<std::mutex> lk(rings_mutex);
+        return rings.size();
+    }
+
+private:
+    struct Slot {
+        uint64_t ticks;
+        OpType type;
+        int32_t idx;
+        int32_t value;
+    };
+
+    struct Ring {
+        Ring(size_t capacity, uint32_t thread, uint64_t owner) : slots(capacity), thread(thread), owner(owner) {}
+
+        std::vector<Slot> slots;
+        uint32_t thread;
+        uint64_t owner;
+        std::ofstream text;
+        alignas(64) std::atomic<size_t> head{ 0 };
+        alignas(64) std::atomic<size_t> tail{ 0 };
+        size_t cached_head = 0;
+        uint64_t last_ticks = 0;
+        uint32_t until_timestamp = 0;
+        size_t stalls = 0;
+    };
+
+    static std::atomic<uint64_t>& next_id() {
+        static std::atomic<uint64_t> counter{ 0 };
+        return counter;
+    }
+
+    // The id, not the address, tells captures apart, so a new capture
+    // allocated where an old one lived never reuses its rings. A thread caches
+    // the ring of the last capture it logged to; on a miss the capture looks
+    // up the ring this thread already owns, so alternating between captures
+    // costs a locked lookup per switch and nothing outlives the capture. The
+    // thread token comes from the id counter, as a std::thread::id can be
+    // reused once its thread exits.
+    Ring& ring_for_this_thread() {
+        thread_local uint64_t cached_id = 0;
+        thread_local Ring* cached_ring = nullptr;
+        if (cached_id == id) return *cached_ring;
+        thread_local uint64_t self = next_id().fetch_add(1) + 1;
+        std::lock_guard<std::mutex> lk(rings_mutex);
+        auto it = std::find_if(rings.begin(), rings.end(), [](const auto& r) { return r->owner == self; });
+        if (it == rings.end()) {
+            rings.push_back(std::make_unique<Ring>(capacity, static_cast<uint32_t>(rings.size()), self));
+            it = rings.end() - 1;
+        }
+        cached_id = id;
+        cached_ring = it->get();
+        return *cached_ring;
+    }
+
+    // Draining in batches keeps the flusher's wakeups rare; it only goes
+    // straight back to work while some ring is more than half full.
+    void flush_loop() {
+        while (!stopping.load(std::memory_order_acquire)) {
+            if (drain_all() < capacity / 2) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        drain_all();
+    }
+
+    // TSC ticks are mapped to ns by the rate seen since the capture started.
+    // Returns the largest batch taken from one ring.
+    size_t drain_all() {
+        std::vector<Ring*> snapshot;
+        {
+            std::lock_guard<std::mutex> lk(rings_mutex);
+            for (const auto& r : rings) snapshot.push_back(r.get());
+        }
+        uint64_t now_ticks = trace_ticks();
+        double now_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start_time).count();
+        double ns_per_tick = now_ticks > start_ticks ? now_ns / (now_ticks - start_ticks) : 1.0;
+
+        size_t drained = 0;
+        size_t largest = 0;
+        for (Ring* ring : snapshot) {
+            size_t head = ring->head.load(std::memory_order_relaxed);
+            size_t tail = ring->tail.load(std::memory_order_acquire);
+            if (head == tail) continue;
+            if (format == TraceFormat::Text) {
+                if (!ring->text.is_open()) ring->text.open(prefix + "_t" + std::to_string(ring->thread) + ".txt");
+                text_buffer.clear();
+                for (size_t i = head; i != tail; ++i) {
+                    const Slot& s = ring->slots[i & (capacity - 1)];
+                    append_op(text_buffer, Op{ s.type, s.idx, s.type == OpType::WRITE ? s.value : 0 });
+                }
+                ring->text << text_buffer;
+            }
+            else {
+                binary_buffer.clear();
+                for (size_t i = head; i != tail; ++i) {
+                    const Slot& s = ring->slots[i & (capacity - 1)];
+                    uint64_t ticks = s.ticks > start_ticks ? s.ticks - start_ticks : 0;
+                    binary_buffer.push_back({ static_cast<uint64_t>(ticks * ns_per_tick), ring->thread,
+                        static_cast<uint32_t>(s.type), s.idx, s.value });
+                }
+                binary.write(reinterpret_cast<const char*>(binary_buffer.data()),
+                    static_cast<std::streamsize>(binary_buffer.size() * sizeof(TraceRecord)));
+            }
+            ring->head.store(tail, std::memory_order_release);
+            drained += tail - head;
+            largest = std::max(largest, tail - head);
+        }
+        written += drained;
+        return largest;
+    }
+
+    std::string prefix;
+    TraceFormat format;
+    uint64_t id;
+    uint32_t timestamp_every;
+    size_t capacity;
+    uint64_t start_ticks;
+    std::chrono::steady_clock::time_point start_time;
+    mutable std::mutex rings_mutex;
+    std::vector<std::unique_ptr<Ring>> rings;
+    std::ofstream binary;
+    std::string text_buffer;
+    std::vector<TraceRecord> binary_buffer;
+    std::atomic<bool> stopping{ false };
+    size_t written = 0;
+    std::thread flusher;
+};
+
+// Reads a binary capture back into one op list per recorded thread, ready to
+// replay through worker or measure_run.
+inline bool load_binary_trace(const std::string& filename, std::vector<std::vector<Op>>& thread_ops) {
+    std::ifstream ifs(filename, std::ios::binary);
+    char magic[sizeof(BINARY_TRACE_MAGIC)] = {};
+    if (!ifs.read(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), BINARY_TRACE_MAGIC)) {
+        return false;
+    }
+    thread_ops.clear();
+    TraceRecord r;
+    while (ifs.read(reinterpret_cast<char*>(&r), sizeof(r))) {
+        if (r.type > static_cast<uint32_t>(OpType::STRING)) return false;
+        if (thread_ops.size() <= r.thread) thread_ops.resize(r.thread + 1);
+        thread_ops[r.thread].push_back(Op{ static_cast<OpType>(r.type), r.idx, r.value });
+    }
+    return true;
+}
+
+// Drop-in wrapper that logs every call on the wrapped field to a TraceCapture
+// before returning. Reads log the value they returned.
+template <typename Field = MultiField>
+class RecordingMultiField {
+public:
+    RecordingMultiField(size_t m, TraceCapture& capture) : inner(m), capture(capture) {}
+
+    int read(size_t idx) const {
+        int value = inner.read(idx);
+        capture.log(OpType::READ, idx, value);
+        return value;
+    }
+
+    void write(size_t idx, int value) {
+        inner.write(idx, value);
+        capture.log(OpType::WRITE, idx, value);
+    }
+
+    std::string to_string() const {
+        std::string s = inner.to_string();
+        capture.log(OpType::STRING, 0, 0);
+        return s;
+    }
+
+    operator std::string() const { return to_string(); }
+
+    size_t size() const { return inner.size(); }
+
+    Field& underlying() { return inner; }
+
+private:
+    Field inner;
+    TraceCapture& capture;
+};
@@ -0,0 +1,457 @@
+#include "traces.h"
+
+#include <iostream>
+#include <sstream>
+#include <fstream>
+#include <atomic>
+#include <algorithm>
+#include <cmath>
+
+#include "alias_table.h"
+#include "worker_pool.h"
+
+std::vector<Op> load_ops(const std::string& filename) {
+    std::ifstream ifs(filename);
+    std::vector<Op> ops;
+    if (!ifs.is_open()) {
+        std::cerr << "Error opening file: " << filename << std::endl;
+        return ops;
+    }
+    std::string cmd;
+    while (ifs >> cmd) {
+        if (cmd == "read") {
+            int idx; ifs >> idx;
+            ops.push_back({ OpType::READ, idx, 0 });
+        }
+        else if (cmd == "write") {
+            int idx, val; ifs >> idx >> val;
+            ops.push_back({ OpType::WRITE, idx, val });
+        }
+        else if (cmd == "string") {
+            ops.push_back({ OpType::STRING, 0, 0 });
+        }
+    }
+    return ops;
+}
+
+const char* trace_source_name(TraceSource s) {
+    switch (s) {
+    case TraceSource::File: return "file";
+    case TraceSource::Memory: return "memory";
+    case TraceSource::Lazy: return "lazy";
+    }
+    return "unknown";
+}
+
+TraceCatalog trace_catalog;
+
+std::vector<std::vector<Op>> materialize_traces(const TraceGenerator& gen, int num_files, int threads,
+    size_t chunk_ops) {
+    std::vector<std::vector<Op>> traces(num_files, std::vector<Op>(gen.count));
+    size_t chunks_per_file = (gen.count + chunk_ops - 1) / chunk_ops;
+    size_t total_chunks = chunks_per_file * num_files;
+    std::atomic<size_t> next{ 0 };
+    WorkerPool pool(threads);
+    pool.run(threads, [&](size_t) {
+        for (size_t t = next.fetch_add(1); t < total_chunks; t = next.fetch_add(1)) {
+            uint32_t file = static_cast<uint32_t>(t / chunks_per_file);
+            size_t first = (t % chunks_per_file) * chunk_ops;
+            size_t last = std::min(gen.count, first + chunk_ops);
+            for (size_t i = first; i < last; ++i) traces[file][i] = gen.op_at(i, file);
+        }
+        });
+    return traces;
+}
+
+std::vector<std::vector<Op>> load_traces(const std::string& file_prefix, int num_threads,
+    const std::string& separator) {
+    if (trace_catalog.source != TraceSource::File && separator == "_t") {
+        if (const TraceGenerator* gen = trace_catalog.find(file_prefix)) {
+            auto& cached = trace_catalog.cache[file_prefix];
+            if (cached.size() < static_cast<size_t>(num_threads)) {
+                cached = materialize_traces(*gen, num_threads, trace_catalog.threads, trace_catalog.chunk_ops);
+            }
+            return std::vector<std::vector<Op>>(cached.begin(), cached.begin() + num_threads);
+        }
+    }
+    std::vector<std::vector<Op>> thread_ops(num_threads);
+    for (int i = 0; i < num_threads; ++i) {
+        thread_ops[i] = load_ops(file_prefix + separator + std::to_string(i) + ".txt");
+    }
+    return thread_ops;
+}
+
+// Philox4x32-10 (Salmon et al., "Parallel random numbers: as easy as 1, 2, 3").
+// Every op draws its randomness from one call keyed by the seed and counted
+// by (op index, file, trace kind), so any op of any file can be generated
+// independently and the output does not depend on how the work is split.
+struct Philox4x32 {
+    uint32_t v[4];
+};
+
+inline Philox4x32 philox4x32(uint64_t seed, uint64_t op, uint32_t file, uint32_t kind) {
+    uint32_t c[4] = { static_cast<uint32_t>(op), static_cast<uint32_t>(op >> 32), file, kind };
+    uint32_t k0 = static_cast<uint32_t>(seed);
+    uint32_t k1 = static_cast<uint32_t>(seed >> 32);
+    for (int round = 0; round < 10; ++round) {
+        uint64_t p0 = uint64_t{ 0xD2511F53 } * c[0];
+        uint64_t p1 = uint64_t{ 0xCD9E8D57 } * c[2];
+        uint32_t n0 = static_cast<uint32_t>(p1 >> 32) ^ c[1] ^ k0;
+        uint32_t n2 = static_cast<uint32_t>(p0 >> 32) ^ c[3] ^ k1;
+        c[1] = static_cast<uint32_t>(p1);
+        c[3] = static_cast<uint32_t>(p0);
+        c[0] = n0;
+        c[2] = n2;
+        k0 += 0x9E3779B9;
+        k1 += 0xBB67AE85;
+    }
+    return { { c[0], c[1], c[2], c[3] } };
+}
+
+// Maps a 32-bit random word onto [0, n) by multiply-shift.
+inline uint32_t bounded(uint32_t word, uint32_t n) {
+    return static_cast<uint32_t>((uint64_t{ word } * n) >> 32);
+}
+
+bool write_trace_files(const TraceGenerator& trace, int num_files, const TraceGenConfig& gen) {
+    std::vector<std::ofstream> files;
+    for (int f = 0; f < num_files; ++f) {
+        files.emplace_back(trace.prefix + "_t" + std::to_string(f) + ".txt");
+        if (!files.back()) {
+            std::cerr << "Cannot write " << trace.prefix << "_t" << f << ".txt\n";
+            return false;
+        }
+    }
+    size_t chunks_per_file = (trace.count + gen.chunk_ops - 1) / gen.chunk_ops;
+    size_t total_chunks = chunks_per_file * num_files;
+    size_t round_size = static_cast<size_t>(gen.threads) * 4;
+    std::vector<std::string> buffers(round_size);
+    WorkerPool pool(gen.threads);
+    for (size_t base = 0; base < total_chunks; base += round_size) {
+        size_t tasks = std::min(round_size, total_chunks - base);
+        std::atomic<size_t> next{ 0 };
+        pool.run(gen.threads, [&](size_t) {
+            for (size_t t = next.fetch_add(1); t < tasks; t = next.fetch_add(1)) {
+                size_t chunk = (base + t) / num_files;
+                uint32_t file = static_cast<uint32_t>((base + t) % num_files);
+                std::string& out = buffers[t];
+                out.clear();
+                size_t last = std::min(trace.count, (chunk + 1) * gen.chunk_ops);
+                for (size_t i = chunk * gen.chunk_ops; i < last; ++i) append_op(out, trace.op_at(i, file));
+            }
+            });
+        for (size_t t = 0; t < tasks; ++t) {
+            files[(base + t) % num_files] << buffers[t];
+        }
+    }
+    return true;
+}
+
+TraceGenerator variant6_trace(size_t count, uint64_t seed) {
+    // read 0, write 0, read 1, write 1, read 2, write 2, string
+    AliasTable actions({ 20, 5, 20, 5, 20, 5, 25 });
+    return { "var6", count, [actions, seed](uint64_t i, uint32_t file) {
+        Philox4x32 r = philox4x32(seed, i, file, 0);
+        int action = static_cast<int>(actions.sample((uint64_t{ r.v[0] } << 32) | r.v[3]));
+        if (action == 6) return Op{ OpType::STRING, 0, 0 };
+        OpType type = action % 2 == 0 ? OpType::READ : OpType::WRITE;
+        return Op{ type, action / 2, type == OpType::WRITE ? 1 + static_cast<int>(bounded(r.v[1], 100)) : 0 };
+    } };
+}
+
+TraceGenerator uniform_trace(size_t count, int m, uint64_t seed) {
+    return { "uniform", count, [m, seed](uint64_t i, uint32_t file) {
+        Philox4x32 r = philox4x32(seed, i, file, 1);
+        uint32_t t = bounded(r.v[0], 3);
+        int field = static_cast<int>(bounded(r.v[1], m));
+        if (t == 0) return Op{ OpType::READ, field, 0 };
+        if (t == 1) return Op{ OpType::WRITE, field, 1 + static_cast<int>(bounded(r.v[2], 100)) };
+        return Op{ OpType::STRING, 0, 0 };
+    } };
+}
+
+TraceGenerator skewed_trace(size_t count, uint64_t seed) {
+    return { "skewed", count, [seed](uint64_t i, uint32_t file) {
+        Philox4x32 r = philox4x32(seed, i, file, 2);
+        if (bounded(r.v[0], 100) < 90) return Op{ OpType::WRITE, 0, 1 + static_cast<int>(bounded(r.v[1], 100)) };
+        return Op{ OpType::STRING, 0, 0 };
+    } };
+}
+
+std::vector<TraceGenerator> demo_traces(size_t count, size_t m, uint64_t seed) {
+    std::vector<double> read_weights(m, 1.0);
+    std::vector<double> write_weights(m, 1.0);
+    read_weights[0] = 8.0;
+    write_weights[0] = 2.0;
+    if (m > 1) write_weights[1] = 6.0;
+    AliasTable reads(read_weights);
+    AliasTable writes(write_weights);
+    TraceGenerator a{ "case_a", count, [reads, writes, seed](uint64_t i, uint32_t file) {
+        Philox4x32 r = philox4x32(seed, i, file, 4);
+        uint32_t t = bounded(r.v[0], 200);
+        if (t < 10) return Op{ OpType::STRING, 0, 0 };
+        uint64_t word = (uint64_t{ r.v[2] } << 32) | r.v[3];
+        if (t < 105) return Op{ OpType::READ, static_cast<int>(reads.sample(word)), 0 };
+        return Op{ OpType::WRITE, static_cast<int>(writes.sample(word)), 1 + static_cast<int>(bounded(r.v[1], 1000)) };
+    } };
+
+    TraceGenerator b = uniform_trace(count, static_cast<int>(m), seed);
+    b.prefix = "case_b";
+
+    // 70% reads and 15% writes of field 0, the rest spread over the others.
+    TraceGenerator c{ "case_c", count, [m, seed](uint64_t i, uint32_t file) {
+        Philox4x32 r = philox4x32(seed, i, file, 5);
+        if (bounded(r.v[0], 1000) == 0) return Op{ OpType::STRING, 0, 0 };
+        uint32_t p = bounded(r.v[1], 100);
+        int value = 1 + static_cast<int>(bounded(r.v[2], 1000));
+        if (p < 70) return Op{ OpType::READ, 0, 0 };
+        if (p < 85) return Op{ OpType::WRITE, 0, value };
+        int field = m > 1 ? 1 + static_cast<int>(bounded(r.v[3], static_cast<uint32_t>(m - 1))) : 0;
+        if (r.v[0] & 1) return Op{ OpType::READ, field, 0 };
+        return Op{ OpType::WRITE, field, value };
+    } };
+    return { a, b, c };
+}
+
+const char* field_dist_name(FieldDist d) {
+    switch (d) {
+    case FieldDist::Uniform: return "uniform";
+    case FieldDist::Zipf: return "zipf";
+    case FieldDist::ScrambledZipf: return "scrambled-zipf";
+    case FieldDist::Hotspot: return "hotspot";
+    case FieldDist::Latest: return "latest";
+    }
+    return "unknown";
+}
+
+bool parse_field_dist(const std::string& text, FieldDist& dist) {
+    const FieldDist all[] = { FieldDist::Uniform, FieldDist::Zipf, FieldDist::ScrambledZipf, FieldDist::Hotspot,
+        FieldDist::Latest };
+    for (FieldDist d : all) {
+        if (text == field_dist_name(d)) {
+            dist = d;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Picks a field index in O(1) per sample, in the manner of the YCSB
+// generators. Zipf follows Gray et al., "Quickly generating billion-record
+// synthetic databases": zeta(m, theta) is summed once here and each sample is
+// a closed-form inversion. Scrambled-Zipf hashes the Zipf rank so the popular
+// fields are spread over the index range. Hotspot sends hot_ops of the ops
+// uniformly to the first hot_fraction of the fields. Latest is Zipf measured
+// back from a hot field that advances one field every latest_shift_ops ops.
+class FieldSampler {
+public:
+    FieldSampler(size_t m, const FieldDistConfig& cfg) : m(m), cfg(cfg) {
+        if (cfg.kind == FieldDist::Zipf || cfg.kind == FieldDist::ScrambledZipf || cfg.kind == FieldDist::Latest) {
+            double zeta2 = 0;
+            for (size_t i = 1; i <= std::min<size_t>(m, 2); ++i) zeta2 += 1.0 / std::pow(static_cast<double>(i), cfg.theta);
+            zetan = 0;
+            for (size_t i = 1; i <= m; ++i) zetan += 1.0 / std::pow(static_cast<double>(i), cfg.theta);
+            alpha = 1.0 / (1.0 - cfg.theta);
+            half_pow_theta = 1.0 + std::pow(0.5, cfg.theta);
+            eta = m > 1 ? (1.0 - std::pow(2.0 / m, 1.0 - cfg.theta)) / (1.0 - zeta2 / zetan) : 0;
+        }
+        hot_fields = std::max<size_t>(1, std::min(m, static_cast<size_t>(cfg.hot_fraction * m)));
+    }
+
+    // u is uniform in [0, 1); op is the op's index within its trace.
+    size_t sample(double u, uint64_t op) const {
+        switch (cfg.kind) {
+        case FieldDist::Uniform:
+            return std::min(m - 1, static_cast<size_t>(u * m));
+        case FieldDist::Zipf:
+            return zipf(u);
+        case FieldDist::ScrambledZipf:
+            return fnv1a(zipf(u)) % m;
+        case FieldDist::Hotspot:
+            // Every field is hot: the split is moot, so stay uniform. u < hot_ops
+            // implies hot_ops > 0, and hot_ops == 0 sends everything cold.
+            if (hot_fields == m) return std::min(m - 1, static_cast<size_t>(u * m));
+            if (u < cfg.hot_ops) {
+                return std::min(hot_fields - 1, static_cast<size_t>(u / cfg.hot_ops * hot_fields));
+            }
+            return hot_fields + std::min(m - hot_fields - 1,
+                static_cast<size_t>((u - cfg.hot_ops) / (1.0 - cfg.hot_ops) * (m - hot_fields)));
+        case FieldDist::Latest: {
+            size_t hot = (op / std::max<size_t>(1, cfg.latest_shift_ops)) % m;
+            return (hot + m - zipf(u)) % m;
+        }
+        }
+        return 0;
+    }
+
+private:
+    size_t zipf(double u) const {
+        double uz = u * zetan;
+        if (uz < 1.0) return 0;
+        if (uz < half_pow_theta) return std::min<size_t>(1, m - 1);
+        return std::min(m - 1, static_cast<size_t>(m * std::pow(eta * u - eta + 1.0, alpha)));
+    }
+
+    static uint64_t fnv1a(uint64_t value) {
+        uint64_t hash = 0xCBF29CE484222325ull;
+        for (int i = 0; i < 8; ++i) {
+            hash ^= value & 0xFF;
+            hash *= 0x100000001B3ull;
+            value >>= 8;
+        }
+        return hash;
+    }
+
+    size_t m;
+    FieldDistConfig cfg;
+    double zetan = 0;
+    double alpha = 0;
+    double eta = 0;
+    double half_pow_theta = 0;
+    size_t hot_fields = 1;
+};
+
+// Two Philox words as a double in [0, 1) with 53 random bits.
+inline double unit_double(uint32_t hi, uint32_t lo) {
+    return static_cast<double>(((uint64_t{ hi } << 32) | lo) >> 11) * 0x1.0p-53;
+}
+
+std::string keyed_case_name(const KeyedTraceConfig& cfg) {
+    std::ostringstream oss;
+    oss << field_dist_name(cfg.dist.kind);
+    if (cfg.dist.kind == FieldDist::Zipf || cfg.dist.kind == FieldDist::ScrambledZipf || cfg.dist.kind == FieldDist::Latest) {
+        oss << " theta=" << cfg.dist.theta;
+    }
+    return oss.str();
+}
+
+std::string keyed_prefix(const KeyedTraceConfig& cfg) {
+    std::ostringstream oss;
+    oss << "keyed_" << field_dist_name(cfg.dist.kind) << "_" << cfg.dist.theta;
+    return oss.str();
+}
+
+TraceGenerator keyed_trace(size_t count, const KeyedTraceConfig& cfg, uint64_t seed) {
+    FieldSampler sampler(cfg.m, cfg.dist);
+    int read_pct = cfg.read_pct;
+    int write_pct = cfg.write_pct;
+    return { keyed_prefix(cfg), count, [sampler, read_pct, write_pct, seed](uint64_t i, uint32_t file) {
+        Philox4x32 r = philox4x32(seed, i, file, 3);
+        int t = static_cast<int>(bounded(r.v[0], 100));
+        if (t >= read_pct + write_pct) return Op{ OpType::STRING, 0, 0 };
+        int field = static_cast<int>(sampler.sample(unit_double(r.v[1], r.v[2]), i));
+        if (t < read_pct) return Op{ OpType::READ, field, 0 };
+        return Op{ OpType::WRITE, field, 1 + static_cast<int>(bounded(r.v[3], 100)) };
+    } };
+}
+
+TraceGenerator phase_trace(const Phase& phase, size_t m, size_t count, uint64_t seed, uint32_t kind) {
+    FieldSampler sampler(m, phase.dist);
+    int read_pct = phase.read_pct;
+    int write_pct = phase.write_pct;
+    size_t offset = phase.hot_offset % m;
+    return { phase.name, count, [sampler, read_pct, write_pct, offset, m, seed, kind](uint64_t i, uint32_t file) {
+        Philox4x32 r = philox4x32(seed, i, file, kind);
+        int t = static_cast<int>(bounded(r.v[0], 100));
+        if (t >= read_pct + write_pct) return Op{ OpType::STRING, 0, 0 };
+        int field = static_cast<int>((sampler.sample(unit_double(r.v[1], r.v[2]), i) + offset) % m);
+        if (t < read_pct) return Op{ OpType::READ, field, 0 };
+        return Op{ OpType::WRITE, field, 1 + static_cast<int>(bounded(r.v[3], 100)) };
+    } };
+}
+
+std::vector<Phase> default_phases(size_t m) {
+    Phase steady{ "steady", 60, 35, {}, 0, 0, 1.0 };
+    steady.dist.kind = FieldDist::Hotspot;
+    steady.dist.hot_fraction = 0.1;
+    steady.dist.hot_ops = 0.9;
+    Phase shift = steady;
+    shift.name = "hot-shift";
+    shift.hot_offset = m / 2;
+    Phase burst = shift;
+    burst.name = "string-burst";
+    burst.read_pct = 20;
+    burst.write_pct = 10;
+    burst.seconds = 0.5;
+    Phase recover = steady;
+    recover.name = "recover";
+    recover.hot_offset = m / 4;
+    return { steady, shift, burst, recover };
+}
+
+bool set_phase_option(Phase& phase, const std::string& key, const std::string& value, std::string& error) {
+    char slash = 0;
+    std::istringstream v(value);
+    try {
+        if (key == "mix") {
+            if (!(v >> phase.read_pct >> slash >> phase.write_pct) || slash != '/' || phase.read_pct < 0
+                || phase.write_pct < 0 || phase.read_pct + phase.write_pct > 100) {
+                error = "bad mix in phase " + phase.name + ": " + value;
+                return false;
+            }
+        }
+        else if (key == "dist") {
+            if (!parse_field_dist(value, phase.dist.kind)) {
+                error = "bad distribution in phase " + phase.name + ": " + value;
+                return false;
+            }
+        }
+        else if (key == "theta") {
+            phase.dist.theta = std::stod(value);
+            if (phase.dist.theta < 0 || phase.dist.theta >= 1) {
+                error = "bad theta in phase " + phase.name + " (expected 0 <= theta < 1)";
+                return false;
+            }
+        }
+        else if (key == "hot-fraction") phase.dist.hot_fraction = std::clamp(std::stod(value), 0.0, 1.0);
+        else if (key == "hot-ops") phase.dist.hot_ops = std::clamp(std::stod(value), 0.0, 1.0);
+        else if (key == "hot") phase.hot_offset = std::stoul(value);
+        else if (key == "ops") phase.ops = std::stoul(value);
+        else if (key == "seconds") phase.seconds = std::stod(value);
+        else {
+            error = "unknown phase setting " + key;
+            return false;
+        }
+    }
+    catch (const std::exception&) {
+        error = "bad value for " + key + " in phase " + phase.name + ": " + value;
+        return false;
+    }
+    return true;
+}
+
+bool check_phase(const Phase& phase, std::string& error) {
+    if (phase.ops == 0 && phase.seconds <= 0) {
+        error = "phase " + phase.name + " needs ops= or seconds=";
+        return false;
+    }
+    return true;
+}
+
+bool parse_phases(const std::string& text, std::vector<Phase>& phases) {
+    phases.clear();
+    std::istringstream specs(text);
+    std::string spec;
+    std::string error;
+    while (std::getline(specs, spec, ';')) {
+        if (spec.empty()) continue;
+        Phase phase;
+        std::istringstream items(spec);
+        std::string item;
+        std::getline(items, phase.name, ',');
+        while (std::getline(items, item, ',')) {
+            size_t eq = item.find('=');
+            std::string value = eq == std::string::npos ? "" : item.substr(eq + 1);
+            if (!set_phase_option(phase, item.substr(0, eq), value, error)) {
+                std::cerr << error << "\n";
+                return false;
+            }
+        }
+        if (!check_phase(phase, error)) {
+            std::cerr << error << "\n";
+            return false;
+        }
+        phases.push_back(phase);
+    }
+    return !phases.empty();
+}
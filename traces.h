@@ -0,0 +1,134 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <map>
+#include <functional>
+#include <cstdint>
+#include <cstddef>
+
+#include "multi_field.h"
+
+// Reads one trace file in the "read i" / "write i v" / "string" format.
+std::vector<Op> load_ops(const std::string& filename);
+
+enum class TraceSource { File, Memory, Lazy };
+
+const char* trace_source_name(TraceSource s);
+
+// A generated trace family: op_at(i, file) computes op i of trace `file` on its
+// own, so the same ops can be written to disk, built in memory or replayed
+// lazily.
+struct TraceGenerator {
+    std::string prefix;
+    size_t count = 0;
+    std::function<Op(uint64_t, uint32_t)> op_at;
+};
+
+// Generated traces by prefix. Unless the source is File, load_traces builds a
+// registered trace in memory on first use and serves it from the cache
+// afterwards instead of reading <prefix>_t<i>.txt.
+struct TraceCatalog {
+    TraceSource source = TraceSource::Memory;
+    int threads = 1;
+    size_t chunk_ops = 1 << 16;
+    std::vector<TraceGenerator> generators;
+    std::map<std::string, std::vector<std::vector<Op>>> cache;
+
+    const TraceGenerator* find(const std::string& prefix) const {
+        for (const auto& g : generators) {
+            if (g.prefix == prefix) return &g;
+        }
+        return nullptr;
+    }
+};
+
+extern TraceCatalog trace_catalog;
+
+std::vector<std::vector<Op>> materialize_traces(const TraceGenerator& gen, int num_files, int threads,
+    size_t chunk_ops);
+
+std::vector<std::vector<Op>> load_traces(const std::string& file_prefix, int num_threads,
+    const std::string& separator = "_t");
+
+struct TraceGenConfig {
+    uint64_t seed = 0;
+    int threads = 1;
+    size_t chunk_ops = 1 << 16;
+};
+
+// Writes <prefix>_t<f>.txt for every file. Chunks of chunk_ops lines from all
+// files are formatted in parallel a round at a time and appended in order, so
+// memory stays bounded and the files are identical for any thread count.
+bool write_trace_files(const TraceGenerator& trace, int num_files, const TraceGenConfig& gen);
+
+TraceGenerator variant6_trace(size_t count, uint64_t seed);
+TraceGenerator uniform_trace(size_t count, int m, uint64_t seed);
+TraceGenerator skewed_trace(size_t count, uint64_t seed);
+
+// The three cases of the original demo over m fields: (a) reads and writes
+// drawn from fixed per-field weights with 5% strings, (b) uniform, (c) most
+// traffic on field 0 with rare strings. Prefixes are case_a, case_b, case_c.
+std::vector<TraceGenerator> demo_traces(size_t count, size_t m, uint64_t seed);
+
+enum class FieldDist { Uniform, Zipf, ScrambledZipf, Hotspot, Latest };
+
+const char* field_dist_name(FieldDist d);
+bool parse_field_dist(const std::string& text, FieldDist& dist);
+
+struct FieldDistConfig {
+    FieldDist kind = FieldDist::Uniform;
+    double theta = 0.99;
+    double hot_fraction = 0.2;
+    double hot_ops = 0.8;
+    size_t latest_shift_ops = 1000;
+};
+
+struct KeyedTraceConfig {
+    FieldDistConfig dist;
+    size_t m = 1000;
+    int read_pct = 50;
+    int write_pct = 45;
+};
+
+std::string keyed_case_name(const KeyedTraceConfig& cfg);
+std::string keyed_prefix(const KeyedTraceConfig& cfg);
+
+// Read/write/string mix over m fields whose indices follow cfg.dist; the rest
+// of the ops after reads and writes are strings.
+TraceGenerator keyed_trace(size_t count, const KeyedTraceConfig& cfg, uint64_t seed);
+
+// One stretch of a phased workload. It ends after `ops` ops per thread, or
+// after `seconds` if that is set. hot_offset rotates the field distribution,
+// so a hotspot or Zipf head can move from one phase to the next.
+struct Phase {
+    std::string name;
+    int read_pct = 50;
+    int write_pct = 45;
+    FieldDistConfig dist;
+    size_t hot_offset = 0;
+    size_t ops = 0;
+    double seconds = 0;
+};
+
+struct PhasedConfig {
+    std::vector<Phase> phases;
+    size_t m = 64;
+    size_t cycle_ops = 1 << 16;
+};
+
+TraceGenerator phase_trace(const Phase& phase, size_t m, size_t count, uint64_t seed, uint32_t kind);
+
+// Steady hotspot traffic whose hot set jumps twice, with a STRING-heavy
+// reporting burst in between.
+std::vector<Phase> default_phases(size_t m);
+
+// Phases are separated by ';', their settings by ','. The first setting is
+// the name; the rest are mix=R/W, dist=<name>, theta=, hot-fraction=,
+// hot-ops=, hot=<offset>, ops= and seconds=.
+bool parse_phases(const std::string& text, std::vector<Phase>& phases);
+
+// One setting of a phase and the final check once all are in, shared by
+// parse_phases and the spec loader. On failure `error` says why.
+bool set_phase_option(Phase& phase, const std::string& key, const std::string& value, std::string& error);
+bool check_phase(const Phase& phase, std::string& error);
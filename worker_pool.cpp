@@ -0,0 +1,140 @@
+#include "worker_pool.h"
+
+#include <sstream>
+#include <fstream>
+#include <tuple>
+#include <cstdlib>
+
+static bool parse_cpu_id(const std::string& text, int& cpu) {
+    char* end = nullptr;
+    long value = std::strtol(text.c_str(), &end, 10);
+    if (text.empty() || *end != '\0' || value < 0 || value >= CPU_SETSIZE) return false;
+    cpu = static_cast<int>(value);
+    return true;
+}
+
+bool parse_cpu_list(const std::string& text, std::vector<int>& cpus) {
+    cpus.clear();
+    std::istringstream iss(text);
+    std::string range;
+    while (std::getline(iss, range, ',')) {
+        if (range.empty()) continue;
+        size_t dash = range.find('-');
+        int first = 0;
+        int last = 0;
+        if (!parse_cpu_id(range.substr(0, dash), first)) return false;
+        if (dash == std::string::npos) last = first;
+        else if (!parse_cpu_id(range.substr(dash + 1), last) || last < first) return false;
+        for (int c = first; c <= last; ++c) cpus.push_back(c);
+    }
+    return !cpus.empty();
+}
+
+static int read_sys_int(const std::string& path, int fallback) {
+    std::ifstream ifs(path);
+    int value;
+    return (ifs >> value) ? value : fallback;
+}
+
+std::vector<CpuInfo> read_cpu_topology() {
+    const std::string base = "/sys/devices/system/cpu/";
+    std::vector<int> online;
+    {
+        std::ifstream ifs(base + "online");
+        std::string text;
+        if (ifs >> text) parse_cpu_list(text, online);
+    }
+    if (online.empty()) {
+        for (unsigned c = 0; c < std::max(1u, std::thread::hardware_concurrency()); ++c) online.push_back(c);
+    }
+
+    std::vector<CpuInfo> topo;
+    for (int cpu : online) {
+        std::string dir = base + "cpu" + std::to_string(cpu) + "/topology/";
+        topo.push_back({ cpu, read_sys_int(dir + "core_id", cpu), read_sys_int(dir + "physical_package_id", 0), 0 });
+    }
+    std::sort(topo.begin(), topo.end(), [](const CpuInfo& a, const CpuInfo& b) {
+        return std::tie(a.package, a.core, a.cpu) < std::tie(b.package, b.core, b.cpu);
+        });
+    for (size_t i = 1; i < topo.size(); ++i) {
+        if (topo[i].package == topo[i - 1].package && topo[i].core == topo[i - 1].core) {
+            topo[i].smt_index = topo[i - 1].smt_index + 1;
+        }
+    }
+    return topo;
+}
+
+std::vector<int> plan_placement(const PlacementPolicy& policy, const std::vector<CpuInfo>& topo) {
+    std::vector<CpuInfo> order = topo;
+    switch (policy.kind) {
+    case Placement::None:
+        return {};
+    case Placement::List:
+        return policy.cpus;
+    case Placement::Compact:
+        break;
+    case Placement::NoSmt:
+        order.erase(std::remove_if(order.begin(), order.end(),
+            [](const CpuInfo& c) { return c.smt_index != 0; }), order.end());
+        break;
+    case Placement::Scatter: {
+        std::vector<int> core_rank(order.size(), 0);
+        for (size_t i = 1; i < order.size(); ++i) {
+            bool same_package = order[i].package == order[i - 1].package;
+            bool new_core = order[i].core != order[i - 1].core;
+            core_rank[i] = !same_package ? 0 : core_rank[i - 1] + (new_core ? 1 : 0);
+        }
+        std::vector<size_t> idx(order.size());
+        for (size_t i = 0; i < idx.size(); ++i) idx[i] = i;
+        std::stable_sort(idx.begin(), idx.end(), [&](size_t a, size_t b) {
+            return std::tie(order[a].smt_index, core_rank[a], order[a].package)
+                < std::tie(order[b].smt_index, core_rank[b], order[b].package);
+            });
+        std::vector<CpuInfo> scattered;
+        for (size_t i : idx) scattered.push_back(order[i]);
+        order.swap(scattered);
+        break;
+    }
+    }
+    std::vector<int> cpus;
+    for (const auto& c : order) cpus.push_back(c.cpu);
+    return cpus;
+}
+
+const char* placement_name(Placement kind) {
+    switch (kind) {
+    case Placement::None: return "none";
+    case Placement::Compact: return "compact";
+    case Placement::Scatter: return "scatter";
+    case Placement::NoSmt: return "no-smt";
+    case Placement::List: return "list";
+    }
+    return "unknown";
+}
+
+bool parse_placement(const std::string& text, PlacementPolicy& policy) {
+    if (text == "none") policy.kind = Placement::None;
+    else if (text == "compact") policy.kind = Placement::Compact;
+    else if (text == "scatter") policy.kind = Placement::Scatter;
+    else if (text == "no-smt") policy.kind = Placement::NoSmt;
+    else if (text.rfind("list:", 0) == 0) {
+        policy.kind = Placement::List;
+        return parse_cpu_list(text.substr(5), policy.cpus);
+    }
+    else return false;
+    return true;
+}
+
+void apply_placement(WorkerPool& pool, const PlacementPolicy& policy) {
+    std::vector<int> cpus = plan_placement(policy, read_cpu_topology());
+    std::string label = placement_name(policy.kind);
+    if (!cpus.empty()) {
+        if (!pool.pin(cpus, label)) {
+            std::cerr << "Placement " << label << " applied only in part; results are labelled "
+                << pool.placement() << "\n";
+        }
+        std::cout << "Placement: " << label << " ->";
+        for (size_t i = 0; i < pool.size(); ++i) std::cout << " " << cpus[i % cpus.size()];
+        std::cout << "\n";
+    }
+}
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <algorithm>
+#include <iostream>
+#include <cstdint>
+#include <stdexcept>
+#include <pthread.h>
+#include <sched.h>
+
+// Persistent threads that run one task at a time: run(n, fn) calls fn(i) on
+// workers 0..n-1 and returns when all of them are done.
+class WorkerPool {
+public:
+    explicit WorkerPool(size_t size) {
+        threads.reserve(size);
+        for (size_t i = 0; i < size; ++i) {
+            threads.emplace_back(&WorkerPool::loop, this, i);
+        }
+        run(size, [](size_t) {});
+    }
+
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lk(mtx);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& t : threads) t.join();
+    }
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    size_t size() const { return threads.size(); }
+
+    const std::string& placement() const { return placement_label; }
+
+    // A worker that cannot be pinned keeps running unpinned, and the label
+    // gets a "-partial" suffix so results do not claim the full placement.
+    bool pin(const std::vector<int>& cpus, const std::string& label) {
+        bool ok = true;
+        for (size_t i = 0; i < threads.size() && !cpus.empty(); ++i) {
+            int cpu = cpus[i % cpus.size()];
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            if (cpu < 0 || cpu >= CPU_SETSIZE) {
+                std::cerr << "Cannot pin worker " << i << " to cpu " << cpu << ": out of range\n";
+                ok = false;
+                continue;
+            }
+            CPU_SET(cpu, &set);
+            if (pthread_setaffinity_np(threads[i].native_handle(), sizeof(set), &set) != 0) {
+                std::cerr << "Cannot pin worker " << i << " to cpu " << cpu << "\n";
+                ok = false;
+            }
+        }
+        placement_label = ok ? label : label + "-partial";
+        return ok;
+    }
+
+    // Runners pair run(n) with an n-party start barrier, so starting fewer
+    // than n workers would hang them; asking for more than size() throws.
+    void run(size_t n, const std::function<void(size_t)>& fn) {
+        if (n > threads.size()) {
+            throw std::invalid_argument("WorkerPool::run: " + std::to_string(n) + " tasks for "
+                + std::to_string(threads.size()) + " workers");
+        }
+        std::unique_lock<std::mutex> lk(mtx);
+        task = &fn;
+        active = n;
+        remaining = active;
+        ++generation;
+        wake.notify_all();
+        done.wait(lk, [this] { return remaining == 0; });
+        task = nullptr;
+    }
+
+private:
+    void loop(size_t id) {
+        uint64_t seen = 0;
+        std::unique_lock<std::mutex> lk(mtx);
+        while (true) {
+            wake.wait(lk, [&] { return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+            if (id >= active) continue;
+            const auto* fn = task;
+            lk.unlock();
+            (*fn)(id);
+            lk.lock();
+            if (--remaining == 0) done.notify_one();
+        }
+    }
+
+    std::vector<std::thread> threads;
+    std::mutex mtx;
+    std::condition_variable wake;
+    std::condition_variable done;
+    const std::function<void(size_t)>* task = nullptr;
+    size_t active = 0;
+    size_t remaining = 0;
+    uint64_t generation = 0;
+    bool stopping = false;
+    std::string placement_label = "none";
+};
+
+enum class Placement { None, Compact, Scatter, NoSmt, List };
+
+struct PlacementPolicy {
+    Placement kind = Placement::None;
+    std::vector<int> cpus;
+};
+
+struct CpuInfo {
+    int cpu;
+    int core;
+    int package;
+    int smt_index;
+};
+
+// Parses "0-3,8,10-11"; false on anything that is not a valid CPU id.
+bool parse_cpu_list(const std::string& text, std::vector<int>& cpus);
+std::vector<CpuInfo> read_cpu_topology();
+
+// Compact fills every SMT sibling of a core before moving on, scatter spreads
+// across packages and physical cores first, no-smt uses one sibling per core.
+std::vector<int> plan_placement(const PlacementPolicy& policy, const std::vector<CpuInfo>& topo);
+
+const char* placement_name(Placement kind);
+bool parse_placement(const std::string& text, PlacementPolicy& policy);
+
+// Pins the pool's workers as the policy says and prints the mapping.
+void apply_placement(WorkerPool& pool, const PlacementPolicy& policy);